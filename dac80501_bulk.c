@@ -0,0 +1,433 @@
+#include "dac80501_bulk.h"
+#include "dac80501_private.h"
+
+#if DAC80501_ENABLE_BULK
+
+//双精度内核的SIMD实现只在双精度运算时编译
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#endif
+
+/*
+    （1）定义批量换算使用的常量
+*/
+
+//单精度电压先转换为双精度再换算，每次转换的个数
+#define DAC80501_BULK_BLOCK 64
+
+//SIMD每次处理的电压个数
+#if defined(__AVX__)
+#define DAC80501_BULK_LANES 4
+#elif defined(__SSE2__)
+#define DAC80501_BULK_LANES 2
+#else
+#define DAC80501_BULK_LANES 1
+#endif
+
+/*
+    整数内核的满量程单位为2^-DAC80501_BULK_UV_SHIFT uV
+    定点运算时驱动的参考电压数组本身以uV为单位（一半量程向下取整），直接使用；
+    浮点运算时一半量程可能不是整数uV，以0.5uV为单位保持精确
+*/
+#if DAC80501_MATH == DAC80501_MATH_FIXED
+#define DAC80501_BULK_UV_SHIFT 0
+#else
+#define DAC80501_BULK_UV_SHIFT 1
+#endif
+
+//DAC80501_MAX_VOUT，单位uV
+#define DAC80501_BULK_LIMIT_UV ((uint32_t)(DAC80501_MAX_VOUT * 1000000.0 + 0.5))
+
+
+/*
+    （2）实现换算内核
+    换算步骤与SetDacOut一致：range = (v > ref_volt[0]) + (v > ref_volt[1])，
+    code = round((v * 65536) / ref_volt[range])，满量程时取65535。
+    round对非负数等价于取整数部分后，小数部分不小于0.5时加1，满量程时结果为65536，统一限幅为65535
+*/
+
+//写入一帧DAC数据
+static inline void Dac80501_Bulk_Frame(uint8_t* frame, uint32_t code)
+{
+    frame[0] = DAC;
+    frame[1] = (code >> 8) & 0xFF;
+    frame[2] = code & 0xFF;
+}
+
+/*
+    整数换算，返回非0表示存在超出范围的电压
+    除法 code = (v * 65536 + den / 2) / den 以倒数乘法代替：先由 q = (v * recip) >> recip_shift 估计商，
+    估计值最多偏小1，再由余数修正一次。只使用32x32->64位乘法、移位和比较，没有除法和分支，
+    适合Cortex-M等没有硬件除法或双精度FPU的平台
+*/
+static uint8_t Dac80501_Bulk_Integer(const dac80501_bulk_t* bulk, const int32_t* vout_uv, uint32_t count, uint8_t* frames, uint8_t* ranges)
+{
+    uint8_t bad = 0;
+
+    for(uint32_t i=0; i<count; i++)
+    {
+        int32_t uv = vout_uv[i];
+
+        //超出范围检查与限幅
+        bad |= (uv < 0) | ((uint32_t)uv > bulk->limit_uv);
+
+        uint32_t v = (uv > 0) ? (uint32_t)uv : 0;
+        v = (v < bulk->limit_uv) ? v : bulk->limit_uv;
+        v <<= DAC80501_BULK_UV_SHIFT;
+
+        //无分支选择量程及满量程
+        uint8_t range = (v > bulk->den[0]) + (v > bulk->den[1]);
+        uint32_t den = bulk->den[range];
+
+        //估计商并修正，结果即为round(v * 65536 / den)
+        uint32_t code = (uint32_t)(((uint64_t)v * bulk->recip[range]) >> bulk->recip_shift[range]);
+        uint64_t rem = ((uint64_t)v << 16) + (den >> 1) - (uint64_t)code * den;
+        code += (rem >= den);
+        code -= (code > DAC80501_MAX_DAC_DATA - 1);
+
+        Dac80501_Bulk_Frame(&frames[i * 3], code);
+
+        if(ranges != NULL)
+            ranges[i] = range;
+    }
+
+    return bad;
+}
+
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+
+//逐点换算，也用于SIMD处理剩余的电压；返回非0表示存在超出范围的电压
+static uint8_t Dac80501_Bulk_Scalar(const dac80501_bulk_t* bulk, const double* vout, uint32_t count, uint8_t* frames, uint8_t* ranges)
+{
+    uint8_t bad = 0;
+
+    for(uint32_t i=0; i<count; i++)
+    {
+        double v = vout[i];
+
+        //取反比较，同时将NaN视为超出范围
+        uint8_t ok = (v >= 0) & (v <= bulk->vout_limit);
+        bad |= !ok;
+
+        v = (v >= 0) ? v : 0;
+        v = (v <= bulk->vout_limit) ? v : bulk->vout_limit;
+
+        uint8_t range = (v > bulk->ref_volt[0]) + (v > bulk->ref_volt[1]);
+        double x = (v * DAC80501_MAX_DAC_DATA) / bulk->ref_volt[range];
+
+        uint32_t code = (uint32_t)x;
+        code += ((x - code) >= 0.5);
+        code -= (code > DAC80501_MAX_DAC_DATA - 1);
+
+        Dac80501_Bulk_Frame(&frames[i * 3], code);
+
+        if(ranges != NULL)
+            ranges[i] = range;
+    }
+
+    return bad;
+}
+
+#if defined(__AVX__)
+
+//AVX实现，每次处理4个电压
+static uint8_t Dac80501_Bulk_Simd(const dac80501_bulk_t* bulk, const double* vout, uint32_t count, uint8_t* frames, uint8_t* ranges)
+{
+    const __m256d zero  = _mm256_setzero_pd();
+    const __m256d one   = _mm256_set1_pd(1.0);
+    const __m256d half  = _mm256_set1_pd(0.5);
+    const __m256d scale = _mm256_set1_pd(DAC80501_MAX_DAC_DATA);
+    const __m256d limit = _mm256_set1_pd(bulk->vout_limit);
+    const __m256d ref0  = _mm256_set1_pd(bulk->ref_volt[0]);
+    const __m256d ref1  = _mm256_set1_pd(bulk->ref_volt[1]);
+    const __m256d ref2  = _mm256_set1_pd(bulk->ref_volt[2]);
+    const __m128i max   = _mm_set1_epi32(DAC80501_MAX_DAC_DATA - 1);
+
+    int bad = 0;
+    int32_t code[4], range[4];
+
+    for(uint32_t i=0; i<count; i+=4)
+    {
+        __m256d v = _mm256_loadu_pd(&vout[i]);
+
+        //超出范围检查与限幅，_mm256_max_pd在v为NaN时返回0
+        __m256d ok = _mm256_and_pd(_mm256_cmp_pd(v, zero, _CMP_GE_OQ), _mm256_cmp_pd(v, limit, _CMP_LE_OQ));
+        bad |= _mm256_movemask_pd(ok) ^ 0xF;
+        v = _mm256_min_pd(_mm256_max_pd(v, zero), limit);
+
+        //无分支选择量程及满量程电压
+        __m256d m0 = _mm256_cmp_pd(v, ref0, _CMP_GT_OQ);
+        __m256d m1 = _mm256_cmp_pd(v, ref1, _CMP_GT_OQ);
+        __m256d vmax = _mm256_blendv_pd(_mm256_blendv_pd(ref0, ref1, m0), ref2, m1);
+
+        //换算并四舍五入
+        __m256d x = _mm256_div_pd(_mm256_mul_pd(v, scale), vmax);
+        __m128i t = _mm256_cvttpd_epi32(x);
+        __m256d f = _mm256_sub_pd(x, _mm256_cvtepi32_pd(t));
+        t = _mm_add_epi32(t, _mm256_cvttpd_epi32(_mm256_and_pd(_mm256_cmp_pd(f, half, _CMP_GE_OQ), one)));
+        t = _mm_add_epi32(t, _mm_cmpgt_epi32(t, max));
+
+        _mm_storeu_si128((__m128i*)code, t);
+        _mm_storeu_si128((__m128i*)range, _mm256_cvttpd_epi32(_mm256_add_pd(_mm256_and_pd(m0, one), _mm256_and_pd(m1, one))));
+
+        for(uint8_t j=0; j<4; j++)
+        {
+            Dac80501_Bulk_Frame(&frames[(i + j) * 3], code[j]);
+
+            if(ranges != NULL)
+                ranges[i + j] = range[j];
+        }
+    }
+
+    return bad != 0;
+}
+
+#elif defined(__SSE2__)
+
+//SSE2实现，每次处理2个电压
+static uint8_t Dac80501_Bulk_Simd(const dac80501_bulk_t* bulk, const double* vout, uint32_t count, uint8_t* frames, uint8_t* ranges)
+{
+    const __m128d zero  = _mm_setzero_pd();
+    const __m128d one   = _mm_set1_pd(1.0);
+    const __m128d half  = _mm_set1_pd(0.5);
+    const __m128d scale = _mm_set1_pd(DAC80501_MAX_DAC_DATA);
+    const __m128d limit = _mm_set1_pd(bulk->vout_limit);
+    const __m128d ref0  = _mm_set1_pd(bulk->ref_volt[0]);
+    const __m128d ref1  = _mm_set1_pd(bulk->ref_volt[1]);
+    const __m128d ref2  = _mm_set1_pd(bulk->ref_volt[2]);
+    const __m128i max   = _mm_set1_epi32(DAC80501_MAX_DAC_DATA - 1);
+
+    int bad = 0;
+    int32_t code[4], range[4];
+
+    for(uint32_t i=0; i<count; i+=2)
+    {
+        __m128d v = _mm_loadu_pd(&vout[i]);
+
+        //超出范围检查与限幅，_mm_max_pd在v为NaN时返回0
+        __m128d ok = _mm_and_pd(_mm_cmpge_pd(v, zero), _mm_cmple_pd(v, limit));
+        bad |= _mm_movemask_pd(ok) ^ 0x3;
+        v = _mm_min_pd(_mm_max_pd(v, zero), limit);
+
+        //无分支选择量程及满量程电压
+        __m128d m0 = _mm_cmpgt_pd(v, ref0);
+        __m128d m1 = _mm_cmpgt_pd(v, ref1);
+        __m128d vmax = _mm_or_pd(_mm_and_pd(m0, ref1), _mm_andnot_pd(m0, ref0));
+        vmax = _mm_or_pd(_mm_and_pd(m1, ref2), _mm_andnot_pd(m1, vmax));
+
+        //换算并四舍五入
+        __m128d x = _mm_div_pd(_mm_mul_pd(v, scale), vmax);
+        __m128i t = _mm_cvttpd_epi32(x);
+        __m128d f = _mm_sub_pd(x, _mm_cvtepi32_pd(t));
+        t = _mm_add_epi32(t, _mm_cvttpd_epi32(_mm_and_pd(_mm_cmpge_pd(f, half), one)));
+        t = _mm_add_epi32(t, _mm_cmpgt_epi32(t, max));
+
+        _mm_storeu_si128((__m128i*)code, t);
+        _mm_storeu_si128((__m128i*)range, _mm_cvttpd_epi32(_mm_add_pd(_mm_and_pd(m0, one), _mm_and_pd(m1, one))));
+
+        for(uint8_t j=0; j<2; j++)
+        {
+            Dac80501_Bulk_Frame(&frames[(i + j) * 3], code[j]);
+
+            if(ranges != NULL)
+                ranges[i + j] = range[j];
+        }
+    }
+
+    return bad != 0;
+}
+
+#endif
+
+//换算双精度电压数组，能被SIMD宽度整除的部分使用SIMD实现
+static uint8_t Dac80501_Bulk_Kernel(const dac80501_bulk_t* bulk, const double* vout, uint32_t count, uint8_t* frames, uint8_t* ranges)
+{
+    uint32_t simd = 0;
+    uint8_t bad = 0;
+
+#if DAC80501_BULK_LANES > 1
+    simd = count - (count % DAC80501_BULK_LANES);
+    bad |= Dac80501_Bulk_Simd(bulk, vout, simd, frames, ranges);
+#endif
+
+    bad |= Dac80501_Bulk_Scalar(bulk, &vout[simd], count - simd, &frames[simd * 3], (ranges != NULL) ? &ranges[simd] : NULL);
+
+    return bad;
+}
+
+#endif
+
+
+/*
+    （3）实现提供给用户调用的应用层接口
+*/
+
+/*
+    保存设备当前的基准电压梯度
+*/
+static DAC80501_Error Dac80501_Bulk_Init(dac80501_bulk_t* bulk, dac80501_t* dev)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若换算模块或设备不存在，直接返回
+    CHECK_PTR(bulk, error, param);
+    CHECK_PTR(dev, error, dev);
+
+    DAC80501_Volt ref_volt;
+    error = dev->GetRefVolt(dev, &ref_volt);
+    if(error.data)
+        return error;
+
+    //基准电压为0时无法换算
+    if(!(ref_volt > 0))
+    {
+        error.ref_volt = 1;
+		DAC80501_PRINT_DEBUG("The ref_volt(%lfV) is not bigger than 0V.\n", DAC80501_PRINT_VOLT(ref_volt));
+        return error;
+    }
+
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+    //与驱动内部参考电压数组的计算方式保持一致
+    bulk->ref_volt[0] = ref_volt / 2.0;
+    bulk->ref_volt[1] = ref_volt;
+    bulk->ref_volt[2] = ref_volt * 2.0;
+    bulk->vout_limit = (bulk->ref_volt[2] < DAC80501_MAX_VOUT) ? bulk->ref_volt[2] : DAC80501_MAX_VOUT;
+#endif
+
+    //整数内核的参考电压梯度，定点运算时与驱动内部的参考电压数组相同
+#if DAC80501_MATH == DAC80501_MATH_FIXED
+    uint32_t ref_uv = (uint32_t)ref_volt;
+
+    bulk->den[0] = ref_uv / 2;
+#else
+    uint32_t ref_uv = (uint32_t)(ref_volt * (DAC80501_Volt)1000000 + (DAC80501_Volt)0.5);
+
+    bulk->den[0] = ref_uv;
+#endif
+    bulk->den[1] = ref_uv << DAC80501_BULK_UV_SHIFT;
+    bulk->den[2] = ref_uv << (DAC80501_BULK_UV_SHIFT + 1);
+    bulk->limit_uv = (ref_uv * 2 < DAC80501_BULK_LIMIT_UV) ? ref_uv * 2 : DAC80501_BULK_LIMIT_UV;
+
+    //基准电压不足1uV时无法换算
+    if(bulk->den[0] == 0)
+    {
+        error.ref_volt = 1;
+		DAC80501_PRINT_DEBUG("The ref_volt(%lfV) is too small.\n", DAC80501_PRINT_VOLT(ref_volt));
+        return error;
+    }
+
+    //倒数取2^(b+30)/den，b为den的位数，倒数小于2^31，估计商的误差小于2^-14
+    for(uint8_t i=0; i<3; i++)
+    {
+        uint8_t b = 0;
+        while((bulk->den[i] >> b) != 0)
+            b++;
+
+        bulk->recip[i] = (uint32_t)(((uint64_t)1 << (b + 30)) / bulk->den[i]);
+        bulk->recip_shift[i] = b + 30 - 16;
+    }
+
+    return error;
+}
+
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+
+/*
+    将电压数组换算为DAC数据帧
+*/
+static DAC80501_Error Dac80501_Bulk_EncodeDouble(dac80501_bulk_t* bulk, const double* vout, const uint32_t count, uint8_t* frames, uint8_t* ranges)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若换算模块或缓冲区不存在，直接返回
+    CHECK_PTR(bulk, error, param);
+    CHECK_PTR(vout, error, param);
+    CHECK_PTR(frames, error, param);
+
+    error.out_volt = Dac80501_Bulk_Kernel(bulk, vout, count, frames, ranges);
+
+    return error;
+}
+
+/*
+    将单精度电压数组换算为DAC数据帧
+*/
+static DAC80501_Error Dac80501_Bulk_EncodeFloat(dac80501_bulk_t* bulk, const float* vout, const uint32_t count, uint8_t* frames, uint8_t* ranges)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若换算模块或缓冲区不存在，直接返回
+    CHECK_PTR(bulk, error, param);
+    CHECK_PTR(vout, error, param);
+    CHECK_PTR(frames, error, param);
+
+    double block[DAC80501_BULK_BLOCK];
+    uint8_t bad = 0;
+
+    for(uint32_t i=0; i<count; i+=DAC80501_BULK_BLOCK)
+    {
+        uint32_t n = (count - i < DAC80501_BULK_BLOCK) ? (count - i) : DAC80501_BULK_BLOCK;
+
+        for(uint32_t j=0; j<n; j++)
+            block[j] = vout[i + j];
+
+        bad |= Dac80501_Bulk_Kernel(bulk, block, n, &frames[i * 3], (ranges != NULL) ? &ranges[i] : NULL);
+    }
+
+    error.out_volt = bad;
+
+    return error;
+}
+
+#endif
+
+/*
+    将定点电压数组换算为DAC数据帧
+*/
+static DAC80501_Error Dac80501_Bulk_EncodeMicrovolt(dac80501_bulk_t* bulk, const int32_t* vout_uv, const uint32_t count, uint8_t* frames, uint8_t* ranges)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若换算模块或缓冲区不存在，直接返回
+    CHECK_PTR(bulk, error, param);
+    CHECK_PTR(vout_uv, error, param);
+    CHECK_PTR(frames, error, param);
+
+    error.out_volt = Dac80501_Bulk_Integer(bulk, vout_uv, count, frames, ranges);
+
+    return error;
+}
+
+
+/*
+    （4）给出初始化批量换算模块的函数接口
+*/
+
+DAC80501_Error DAC80501_BULK_API_INIT(dac80501_bulk_t* bulk)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若换算模块不存在，直接返回
+    CHECK_PTR(bulk, error, param);
+
+    //绑定函数接口
+    bulk->Init              = Dac80501_Bulk_Init;
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+    bulk->EncodeDouble      = Dac80501_Bulk_EncodeDouble;
+    bulk->EncodeFloat       = Dac80501_Bulk_EncodeFloat;
+#endif
+    bulk->EncodeMicrovolt   = Dac80501_Bulk_EncodeMicrovolt;
+
+    return error;
+}
+
+#endif /* DAC80501_ENABLE_BULK */
@@ -0,0 +1,89 @@
+#ifndef __DAC80501_BULK_H__
+#define __DAC80501_BULK_H__
+/*
+@filename   dac80501_bulk.h
+
+@brief		DAC80501批量电压换算模块头文件，用于预先生成波形缓冲区
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    1.0
+
+@attention  （1）Init时保存设备当前的基准电压梯度，此后的换算与设备状态无关，基准电压改变后须重新Init；
+            （2）换算结果与SetDacOut逐个换算得到的量程和DAC数据完全一致，量程选择不使用分支；
+            （3）EncodeDouble和EncodeFloat只在DAC80501_MATH_DOUBLE时提供，主机编译时依据编译器预定义的
+                 __AVX__或__SSE2__宏自动选择SIMD实现，否则使用无分支的逐点循环；
+            （4）超出0V~min(两倍基准电压, DAC80501_MAX_VOUT)的电压被限幅后换算，并返回out_volt错误；
+            （5）EncodeMicrovolt在所有电压运算方式下可用，使用不含除法和浮点运算的整数内核，适合Cortex-M；
+                 DAC80501_MATH_FIXED时与SetDacOut完全一致，浮点运算时基准电压按整数uV换算，
+                 基准电压为整数uV时与双精度的SetDacOut一致，而单精度的SetDacOut在舍入边界附近可能相差1LSB。
+*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//引入系统头文件
+#include <stdint.h>
+#include "dac80501_spi.h"
+
+typedef struct _dac80501_bulk_t dac80501_bulk_t;
+
+struct _dac80501_bulk_t
+{
+    //以下成员由驱动内部维护，禁止直接修改
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+    double ref_volt[3];     //各量程的满量程电压，与驱动内部的参考电压数组一致
+    double vout_limit;      //可输出的最大电压
+#endif
+    uint32_t den[3];        //整数内核使用的各量程满量程，单位见dac80501_bulk.c
+    uint32_t recip[3];      //各量程满量程的倒数，用于以乘法代替除法
+    uint8_t  recip_shift[3];//倒数乘积需要右移的位数
+    uint32_t limit_uv;      //可输出的最大电压，单位uV
+
+    //操作接口
+
+    /*
+        保存设备当前的基准电压梯度
+        dev: 已初始化的DAC80501设备
+    */
+    DAC80501_Error (* Init)(dac80501_bulk_t* bulk, dac80501_t* dev);
+
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+    /*
+        将电压数组换算为DAC数据帧
+        vout: 电压数组，单位V
+        count: 电压个数
+        frames: 保存DAC数据帧的缓冲区，长度至少为count * 3字节，每帧依次为寄存器地址、数据高字节、数据低字节
+        ranges: 保存每个电压所需量程的缓冲区，取值见DAC80501_Range；为NULL时不保存
+    */
+    DAC80501_Error (* EncodeDouble)(dac80501_bulk_t* bulk, const double* vout, const uint32_t count, uint8_t* frames, uint8_t* ranges);
+
+    /*
+        将单精度电压数组换算为DAC数据帧，参数同EncodeDouble
+    */
+    DAC80501_Error (* EncodeFloat)(dac80501_bulk_t* bulk, const float* vout, const uint32_t count, uint8_t* frames, uint8_t* ranges);
+#endif
+
+    /*
+        将定点电压数组换算为DAC数据帧
+        vout_uv: 电压数组，单位uV
+        count: 电压个数
+        frames: 保存DAC数据帧的缓冲区，长度至少为count * 3字节，每帧依次为寄存器地址、数据高字节、数据低字节
+        ranges: 保存每个电压所需量程的缓冲区，取值见DAC80501_Range；为NULL时不保存
+    */
+    DAC80501_Error (* EncodeMicrovolt)(dac80501_bulk_t* bulk, const int32_t* vout_uv, const uint32_t count, uint8_t* frames, uint8_t* ranges);
+};
+
+/*
+    给出初始化批量换算模块的函数接口
+*/
+
+DAC80501_Error DAC80501_BULK_API_INIT(dac80501_bulk_t* bulk);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DAC80501_BULK_H__ */
@@ -0,0 +1,266 @@
+#include "dac80501_ctrl.h"
+#include "dac80501_private.h"
+
+#if DAC80501_ENABLE_CTRL
+
+/*
+    （1）定义控制环内部使用的定点格式
+*/
+
+//输出格式：相对两倍基准电压（即最大量程满量程）的Q24定点数
+#define DAC80501_CTRL_Q         24
+
+//各量程的满量程，Q24格式
+#define DAC80501_CTRL_FS(range) (1L << (DAC80501_CTRL_Q - DAC80501_RANGE_DOUBLE + (range)))
+
+//切换到较小量程的回差，为较小量程满量程的1/16
+#define DAC80501_CTRL_HYST      4
+
+
+/*
+    （2）实现控制环内部函数
+*/
+
+//依据输出选择量程，只在需要时切换
+static uint8_t Dac80501_Ctrl_Range(dac80501_ctrl_t* ctrl, int32_t q)
+{
+    uint8_t range = ctrl->range;
+
+    //超出当前量程时立即切换到能容纳该输出的量程
+    while((range < DAC80501_RANGE_DOUBLE) && (q > DAC80501_CTRL_FS(range)))
+        range++;
+
+    //低于较小量程满量程一定余量时才切换，避免输出在量程边界附近时反复切换
+    while((range > DAC80501_RANGE_HALF) &&
+          (q < DAC80501_CTRL_FS(range - 1) - (DAC80501_CTRL_FS(range - 1) >> DAC80501_CTRL_HYST)))
+        range--;
+
+    return range;
+}
+
+//PID运算，返回未限幅的Q24输出
+static int64_t Dac80501_Ctrl_Pid(dac80501_ctrl_t* ctrl, int32_t measure)
+{
+    int64_t e = (int64_t)ctrl->setpoint - measure;
+
+    //积分项限制在输出范围内
+    int64_t integ = ctrl->integ + (((int64_t)ctrl->ki * e) >> DAC80501_CTRL_GAIN_Q);
+    if(integ < 0)
+        integ = 0;
+    else if(integ > ctrl->q_max)
+        integ = ctrl->q_max;
+
+    ctrl->integ = (int32_t)integ;
+
+    //微分项作用于测量值，第一次运算时没有上一次的测量值
+    int64_t d = 0;
+    if(ctrl->primed)
+        d = ((int64_t)ctrl->kd * ((int64_t)ctrl->measure_last - measure)) >> DAC80501_CTRL_GAIN_Q;
+
+    ctrl->measure_last = measure;
+    ctrl->primed = 1;
+
+    return (((int64_t)ctrl->kp * e) >> DAC80501_CTRL_GAIN_Q) + integ + d;
+}
+
+
+/*
+    （3）实现提供给用户调用的应用层接口
+*/
+
+/*
+    清除积分项和微分项的历史，重新计算输出范围
+*/
+static DAC80501_Error Dac80501_Ctrl_Reset(dac80501_ctrl_t* ctrl)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若控制环或设备不存在，直接返回
+    CHECK_PTR(ctrl, error, dev);
+    CHECK_PTR(ctrl->dev, error, dev);
+
+    DAC80501_Volt ref_volt;
+    error = ctrl->dev->GetRefVolt(ctrl->dev, &ref_volt);
+    if(error.data)
+        return error;
+
+    error = ctrl->dev->GetDacRange(ctrl->dev, &ctrl->range);
+    if(error.data)
+        return error;
+
+    //输出上限取两倍基准电压与DAC80501_MAX_VOUT中的较小值
+    DAC80501_Volt vmax = 2 * ref_volt;
+    if(vmax > DAC80501_VOUT_LIMIT)
+        ctrl->q_max = (int32_t)Dac80501_Scale(DAC80501_VOUT_LIMIT, vmax, DAC80501_CTRL_Q);
+    else
+        ctrl->q_max = 1L << DAC80501_CTRL_Q;
+
+    ctrl->integ     = 0;
+    ctrl->primed    = 0;
+    ctrl->output    = 0;
+    ctrl->last      = -1;
+
+    return error;
+}
+
+/*
+    初始化控制环
+*/
+static DAC80501_Error Dac80501_Ctrl_Init(dac80501_ctrl_t* ctrl, dac80501_t* dev)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若控制环或设备不存在，直接返回
+    CHECK_PTR(ctrl, error, dev);
+    CHECK_PTR(dev, error, dev);
+
+    ctrl->dev       = dev;
+    ctrl->setpoint  = 0;
+    ctrl->kp        = 0;
+    ctrl->ki        = 0;
+    ctrl->kd        = 0;
+    ctrl->slot[0].kernel = NULL;
+    ctrl->slot[0].user   = NULL;
+    ctrl->active    = &ctrl->slot[0];
+    ctrl->user      = NULL;
+
+    return ctrl->Reset(ctrl);
+}
+
+/*
+    设置PID增益
+*/
+static DAC80501_Error Dac80501_Ctrl_SetGains(dac80501_ctrl_t* ctrl, const int32_t kp, const int32_t ki, const int32_t kd)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若控制环不存在，直接返回
+    CHECK_PTR(ctrl, error, dev);
+
+    ctrl->kp = kp;
+    ctrl->ki = ki;
+    ctrl->kd = kd;
+
+    return error;
+}
+
+/*
+    设置设定值
+*/
+static DAC80501_Error Dac80501_Ctrl_SetSetpoint(dac80501_ctrl_t* ctrl, const int32_t setpoint)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若控制环不存在，直接返回
+    CHECK_PTR(ctrl, error, dev);
+
+    ctrl->setpoint = setpoint;
+
+    return error;
+}
+
+/*
+    设置用户控制核
+*/
+static DAC80501_Error Dac80501_Ctrl_SetKernel(dac80501_ctrl_t* ctrl, DAC80501_CtrlKernel kernel, void* user)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若控制环不存在，直接返回
+    CHECK_PTR(ctrl, error, dev);
+
+    //在Step未使用的槽中写入控制核和私有数据，此时被中断仍以旧的一对运算
+    DAC80501_CtrlSlot* slot = (ctrl->active == &ctrl->slot[0]) ? &ctrl->slot[1] : &ctrl->slot[0];
+    slot->kernel = kernel;
+    slot->user   = user;
+
+    //两者写入完成后再以一次指针写入发布
+    DAC80501_MEMORY_BARRIER();
+    ctrl->active = slot;
+
+    return error;
+}
+
+/*
+    执行一次控制运算并写入芯片
+*/
+static DAC80501_Error Dac80501_Ctrl_Step(dac80501_ctrl_t* ctrl, const int32_t measure)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若控制环或设备不存在，直接返回
+    CHECK_PTR(ctrl, error, dev);
+    CHECK_PTR(ctrl->dev, error, dev);
+
+    //只读取一次已发布的槽，控制核与私有数据来自同一次SetKernel
+    const DAC80501_CtrlSlot* slot = ctrl->active;
+    ctrl->user = slot->user;
+
+    int64_t u = (slot->kernel != NULL) ? slot->kernel(ctrl, measure) : Dac80501_Ctrl_Pid(ctrl, measure);
+
+    //限幅：不小于0V，不大于两倍基准电压及DAC80501_MAX_VOUT
+    if(u < 0)
+        u = 0;
+    else if(u > ctrl->q_max)
+        u = ctrl->q_max;
+
+    ctrl->output = (int32_t)u;
+
+    uint8_t range = Dac80501_Ctrl_Range(ctrl, ctrl->output);
+
+    //满量程为两倍基准电压的 1/4、1/2、1 倍，换算只需移位并四舍五入
+    uint8_t shift = (DAC80501_CTRL_Q - 16) - (DAC80501_RANGE_DOUBLE - range);
+    uint32_t code = ((uint32_t)ctrl->output + (1UL << (shift - 1))) >> shift;
+
+    if(code > 0xFFFF)
+        code = 0xFFFF;
+
+    //切换量程时量程与DAC数据一起写入，避免中间输出超调
+    if(range != ctrl->range)
+    {
+        ctrl->range = range;
+        ctrl->last = code;
+
+        return ctrl->dev->SetDacRangeCode(ctrl->dev, range, (uint16_t)code);
+    }
+
+    //DAC数据未改变时不再发送
+    if((int32_t)code == ctrl->last)
+        return error;
+
+    ctrl->last = code;
+
+    return ctrl->dev->SetDacCode(ctrl->dev, (uint16_t)code);
+}
+
+
+/*
+    （4）给出初始化控制环的函数接口
+*/
+
+DAC80501_Error DAC80501_CTRL_API_INIT(dac80501_ctrl_t* ctrl)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若控制环不存在，直接返回
+    CHECK_PTR(ctrl, error, dev);
+
+    //绑定函数接口
+    ctrl->Init          = Dac80501_Ctrl_Init;
+    ctrl->Reset         = Dac80501_Ctrl_Reset;
+    ctrl->SetGains      = Dac80501_Ctrl_SetGains;
+    ctrl->SetSetpoint   = Dac80501_Ctrl_SetSetpoint;
+    ctrl->SetKernel     = Dac80501_Ctrl_SetKernel;
+    ctrl->Step          = Dac80501_Ctrl_Step;
+
+    return error;
+}
+
+#endif /* DAC80501_ENABLE_CTRL */
@@ -0,0 +1,126 @@
+#ifndef __DAC80501_CTRL_H__
+#define __DAC80501_CTRL_H__
+/*
+@filename   dac80501_ctrl.h
+
+@brief		DAC80501控制环执行模块头文件，在一次中断中完成定点PID运算并直接写入DAC数据
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    1.0
+
+@attention  上层调用SetSetpoint写入设定值，采样中断读取传感器后调用Step，Step依次完成PID运算、
+            限幅、量程选择和DAC数据写入，不经过SetDacOut的参数检查和浮点换算。
+
+            （1）设定值与测量值的单位由用户决定（如ADC原始数据），PID增益为Q16定点数，
+                 增益与误差的乘积即为相对两倍基准电压的Q24输出，与插值模块的格式一致；
+            （2）微分项作用于测量值而非误差，设定值突变时不会产生微分冲击；
+                 积分项被限制在输出范围内，输出饱和时不会继续累积；
+            （3）输出被限制在0V~min(两倍基准电压, DAC80501_MAX_VOUT)；
+            （4）输出超出当前量程时立即切换到较大的量程，低于较小量程满量程的15/16时才切换回较小的量程，
+                 量程未改变时只写DAC数据寄存器，DAC数据未改变时不占用SPI总线；
+            （5）可通过SetKernel以用户控制核替换PID运算，限幅与输出过程不变；
+            （6）更改基准电压或在控制环之外直接设置DAC输出后，必须调用Reset。
+*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//引入系统头文件
+#include <stdint.h>
+#include "dac80501_spi.h"
+
+//PID增益的小数位数
+#define DAC80501_CTRL_GAIN_Q 16
+
+typedef struct _dac80501_ctrl_t dac80501_ctrl_t;
+
+/*
+    用户控制核，在Step中代替PID运算
+    measure: 本次测量值
+    返回值: 相对两倍基准电压的Q24输出，超出输出范围时由Step限幅
+*/
+typedef int32_t (* DAC80501_CtrlKernel)(dac80501_ctrl_t* ctrl, const int32_t measure);
+
+//用户控制核及其私有数据，SetKernel以一次指针写入同时发布两者
+typedef struct
+{
+    DAC80501_CtrlKernel kernel;     //用户控制核，为NULL时使用PID
+    void*               user;       //用户控制核的私有数据
+}DAC80501_CtrlSlot;
+
+struct _dac80501_ctrl_t
+{
+    //以下成员由驱动内部维护，禁止直接修改
+    dac80501_t*         dev;            //绑定的DAC80501设备
+    int32_t             q_max;          //输出电压上限，Q24格式
+    uint8_t             range;          //当前使用的量程
+    int32_t             last;           //最后一次写入的DAC数据，为-1时表示尚未写入
+
+    volatile int32_t    setpoint;       //设定值，与测量值单位相同
+    int32_t             kp, ki, kd;     //PID增益，Q16格式
+    int32_t             integ;          //积分项，Q24格式
+    int32_t             measure_last;   //上一次的测量值，用于计算微分项
+    uint8_t             primed;         //为0时表示尚未有上一次的测量值
+    int32_t             output;         //最近一次限幅后的输出，Q24格式，用户控制核可读取
+
+    //SetKernel可能被Step中断，先写入未使用的槽，再以一次指针写入发布，Step读到的控制核与私有数据总是配套的
+    DAC80501_CtrlSlot   slot[2];                    //控制核与私有数据的双缓冲
+    const DAC80501_CtrlSlot* volatile active;       //Step使用的槽
+    void*               user;                       //当前控制核的私有数据，Step在调用控制核前更新，控制核可读取
+
+    //操作接口
+
+    /*
+        初始化控制环，增益和设定值均清零
+        dev: 已初始化的DAC80501设备
+    */
+    DAC80501_Error (* Init)(dac80501_ctrl_t* ctrl, dac80501_t* dev);
+
+    /*
+        清除积分项和微分项的历史，并依据当前基准电压和量程重新计算输出范围
+    */
+    DAC80501_Error (* Reset)(dac80501_ctrl_t* ctrl);
+
+    /*
+        设置PID增益
+        kp, ki, kd: Q16格式，单位为每单位误差对应的Q24输出；ki、kd已包含采样周期
+        注意，中断运行时更改增益，可能有一次Step使用新旧混合的增益
+    */
+    DAC80501_Error (* SetGains)(dac80501_ctrl_t* ctrl, const int32_t kp, const int32_t ki, const int32_t kd);
+
+    /*
+        设置设定值，可在中断运行时调用
+        setpoint: 与测量值单位相同
+    */
+    DAC80501_Error (* SetSetpoint)(dac80501_ctrl_t* ctrl, const int32_t setpoint);
+
+    /*
+        设置用户控制核，可在中断运行时调用，中断总是以配套的控制核和私有数据运算，
+        SetKernel返回前的Step使用旧的控制核，返回后的Step使用新的控制核
+        kernel: 用户控制核，为NULL时恢复PID
+        user: 用户控制核的私有数据
+        注意，不可在多处同时调用；仅保证与同一CPU上的中断之间的顺序，Step在其他CPU核上运行时须由用户加锁
+    */
+    DAC80501_Error (* SetKernel)(dac80501_ctrl_t* ctrl, DAC80501_CtrlKernel kernel, void* user);
+
+    /*
+        执行一次控制运算并写入芯片，在采样中断中调用
+        measure: 本次测量值
+    */
+    DAC80501_Error (* Step)(dac80501_ctrl_t* ctrl, const int32_t measure);
+};
+
+/*
+    给出初始化控制环的函数接口
+*/
+
+DAC80501_Error DAC80501_CTRL_API_INIT(dac80501_ctrl_t* ctrl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DAC80501_CTRL_H__ */
@@ -0,0 +1,288 @@
+#include "dac80501_dither.h"
+#include "dac80501_private.h"
+
+#if DAC80501_ENABLE_DITHER
+
+/*
+    （1）定义抖动模块内部使用的常量
+*/
+
+//目标值的量程字段
+#define DAC80501_DITHER_RANGE_SHIFT 30
+#define DAC80501_DITHER_CODE_MASK   ((1UL << DAC80501_DITHER_RANGE_SHIFT) - 1)
+
+//尚未设定目标值时的标记，量程字段为非法值3
+#define DAC80501_DITHER_IDLE        0xFFFFFFFFUL
+
+
+/*
+    （2）实现抖动模块内部函数
+*/
+
+/*
+    电压换算为含小数位的目标值，只在SetVout中调用
+    移位最多16 + DAC80501_DITHER_MAX_FRAC位，单精度浮点的24位尾数无法保留全部小数位，
+    因此浮点运算时统一以双精度换算，定点运算时沿用64位整数换算
+*/
+static uint32_t Dac80501_Dither_Scale(const DAC80501_Volt vout, const DAC80501_Volt den, const uint8_t shift)
+{
+#if DAC80501_MATH == DAC80501_MATH_FIXED
+    return Dac80501_Scale(vout, den, shift);
+#else
+    return (uint32_t)round(((double)vout * (double)(1UL << shift)) / (double)den);
+#endif
+}
+
+/*
+    对含小数位的目标值做噪声整形量化，返回本次输出的DAC数据
+    一阶：u = x + e[n-1]；二阶：u = x + 2e[n-1] - e[n-2]；y = round(u)，e[n] = u - y
+*/
+static uint16_t Dac80501_Dither_Step(dac80501_dither_t* dither, int32_t target)
+{
+    const uint8_t frac = dither->frac_bits;
+    const int32_t one = (int32_t)1 << frac;
+
+    int32_t u = target + ((dither->order == 2) ? (2 * dither->e1 - dither->e2) : dither->e1);
+    int32_t y = (u + (one >> 1)) >> frac;
+
+    //限幅后误差可能超出1LSB，同样限幅以免误差累积
+    if(y < 0)
+        y = 0;
+    else if(y > DAC80501_MAX_DAC_DATA - 1)
+        y = DAC80501_MAX_DAC_DATA - 1;
+
+    int32_t e = u - (y << frac);
+
+    if(e > one)
+        e = one;
+    else if(e < -one)
+        e = -one;
+
+    dither->e2 = dither->e1;
+    dither->e1 = e;
+
+    return (uint16_t)y;
+}
+
+
+/*
+    （3）实现提供给用户调用的应用层接口
+*/
+
+/*
+    初始化抖动模块
+*/
+static DAC80501_Error Dac80501_Dither_Init(dac80501_dither_t* dither, dac80501_t* dev, const uint8_t order, const uint8_t frac_bits)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若抖动模块或设备不存在，直接返回
+    CHECK_PTR(dither, error, dev);
+    CHECK_PTR(dev, error, dev);
+
+    //若整形阶数或小数位数非法，直接返回
+    if((order < 1) || (order > 2) || (frac_bits < 1) || (frac_bits > DAC80501_DITHER_MAX_FRAC))
+    {
+        error.param = 1;
+		DAC80501_PRINT_DEBUG("The dither order(%d) or frac_bits(%d) is illegal.\n", order, frac_bits);
+        return error;
+    }
+
+    error = dev->GetDacRange(dev, &dither->range);
+    if(error.data)
+        return error;
+
+    dither->dev         = dev;
+    dither->order       = order;
+    dither->frac_bits   = frac_bits;
+    dither->setpoint    = DAC80501_DITHER_IDLE;
+    dither->e1          = 0;
+    dither->e2          = 0;
+    dither->last        = -1;
+
+    return error;
+}
+
+/*
+    以定点数设定目标值
+*/
+static DAC80501_Error Dac80501_Dither_SetCode(dac80501_dither_t* dither, const uint8_t range, const uint32_t code)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若抖动模块不存在，直接返回
+    CHECK_PTR(dither, error, dev);
+
+    //若量程非法，直接返回，以param区分参数错误与GAIN寄存器写入失败
+    if(range > DAC80501_RANGE_DOUBLE)
+    {
+        error.param = 1;
+		DAC80501_PRINT_DEBUG("The range is only set to 0, 1 or 2, but this is %d\n", range);
+        return error;
+    }
+
+    //若目标值超出满量程，直接返回
+    if(code > ((uint32_t)(DAC80501_MAX_DAC_DATA - 1) << dither->frac_bits))
+    {
+        error.out_volt = 1;
+		DAC80501_PRINT_DEBUG("The dither code(%lu) is out of range.\n", (unsigned long)code);
+        return error;
+    }
+
+    //量程与目标值一次写入
+    dither->setpoint = ((uint32_t)range << DAC80501_DITHER_RANGE_SHIFT) | code;
+
+    return error;
+}
+
+/*
+    以电压设定目标值
+*/
+static DAC80501_Error Dac80501_Dither_SetVout(dac80501_dither_t* dither, const DAC80501_Volt vout)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若抖动模块或设备不存在，直接返回
+    CHECK_PTR(dither, error, dev);
+    CHECK_PTR(dither->dev, error, dev);
+
+    DAC80501_Volt ref_volt;
+    error = dither->dev->GetRefVolt(dither->dev, &ref_volt);
+    if(error.data)
+        return error;
+
+    //参考电压数组与驱动内部的计算方式保持一致
+    DAC80501_Volt ladder[3] = {ref_volt / 2, ref_volt, ref_volt * 2};
+
+    //设定电压超出可输出范围，直接返回
+    if(!((vout >= 0) && (vout <= DAC80501_VOUT_LIMIT) && (vout <= ladder[2]) && (ref_volt > 0)))
+    {
+        error.out_volt = 1;
+		DAC80501_PRINT_DEBUG("The expected voltage(%lfV) is out of 0V~%lfV or bigger than %lfV\n",
+		DAC80501_PRINT_VOLT(vout), DAC80501_MAX_VOUT, DAC80501_PRINT_VOLT(ladder[2]));
+        return error;
+    }
+
+    uint8_t range = (vout > ladder[0]) + (vout > ladder[1]);
+    uint32_t max_code = (uint32_t)(DAC80501_MAX_DAC_DATA - 1) << dither->frac_bits;
+    uint32_t code = Dac80501_Dither_Scale(vout, ladder[range], 16 + dither->frac_bits);
+
+    return Dac80501_Dither_SetCode(dither, range, (code > max_code) ? max_code : code);
+}
+
+/*
+    生成下一个DAC数据并写入芯片
+*/
+static DAC80501_Error Dac80501_Dither_Tick(dac80501_dither_t* dither)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若抖动模块或设备不存在，直接返回
+    CHECK_PTR(dither, error, dev);
+    CHECK_PTR(dither->dev, error, dev);
+
+    uint32_t setpoint = dither->setpoint;
+    uint8_t range = setpoint >> DAC80501_DITHER_RANGE_SHIFT;
+
+    //尚未设定目标值
+    if(range > DAC80501_RANGE_DOUBLE)
+        return error;
+
+    //切换量程时清除量化误差，量程与第一个DAC数据一起写入
+    if(range != dither->range)
+    {
+        dither->range = range;
+        dither->e1 = 0;
+        dither->e2 = 0;
+        dither->last = Dac80501_Dither_Step(dither, setpoint & DAC80501_DITHER_CODE_MASK);
+
+        return dither->dev->SetDacRangeCode(dither->dev, range, dither->last);
+    }
+
+    uint16_t code = Dac80501_Dither_Step(dither, setpoint & DAC80501_DITHER_CODE_MASK);
+
+    //DAC数据未改变时不再发送
+    if(code == dither->last)
+        return error;
+
+    dither->last = code;
+
+    return dither->dev->SetDacCode(dither->dev, code);
+}
+
+/*
+    为DMA回填生成连续的DAC数据
+*/
+static DAC80501_Error Dac80501_Dither_Fill(dac80501_dither_t* dither, uint16_t* buf, const uint16_t len, uint16_t* filled)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若抖动模块、设备或缓冲区不存在，直接返回
+    CHECK_PTR(dither, error, dev);
+    CHECK_PTR(dither->dev, error, dev);
+    CHECK_PTR(buf, error, param);
+    CHECK_PTR(filled, error, param);
+
+    uint16_t n = 0;
+    uint32_t setpoint = dither->setpoint;
+    uint8_t range = setpoint >> DAC80501_DITHER_RANGE_SHIFT;
+
+    *filled = 0;
+
+    //尚未设定目标值
+    if(range > DAC80501_RANGE_DOUBLE)
+        return error;
+
+    //需要切换量程时清除量化误差，与Tick相同，量程与第一个DAC数据一起直接写入，避免中间输出超调
+    if(range != dither->range)
+    {
+        dither->range = range;
+        dither->e1 = 0;
+        dither->e2 = 0;
+        dither->last = Dac80501_Dither_Step(dither, setpoint & DAC80501_DITHER_CODE_MASK);
+
+        error = dither->dev->SetDacRangeCode(dither->dev, range, dither->last);
+        if(error.data)
+            return error;
+    }
+
+    while(n < len)
+        buf[n++] = Dac80501_Dither_Step(dither, setpoint & DAC80501_DITHER_CODE_MASK);
+
+    if(n)
+        dither->last = buf[n - 1];
+
+    *filled = n;
+
+    return error;
+}
+
+
+/*
+    （4）给出初始化抖动模块的函数接口
+*/
+
+DAC80501_Error DAC80501_DITHER_API_INIT(dac80501_dither_t* dither)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若抖动模块不存在，直接返回
+    CHECK_PTR(dither, error, dev);
+
+    //绑定函数接口
+    dither->Init    = Dac80501_Dither_Init;
+    dither->SetVout = Dac80501_Dither_SetVout;
+    dither->SetCode = Dac80501_Dither_SetCode;
+    dither->Tick    = Dac80501_Dither_Tick;
+    dither->Fill    = Dac80501_Dither_Fill;
+
+    return error;
+}
+
+#endif /* DAC80501_ENABLE_DITHER */
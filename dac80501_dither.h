@@ -0,0 +1,97 @@
+#ifndef __DAC80501_DITHER_H__
+#define __DAC80501_DITHER_H__
+/*
+@filename   dac80501_dither.h
+
+@brief		DAC80501噪声整形抖动模块头文件，利用空闲的总线带宽获得低于1LSB的平均输出分辨率
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    1.0
+
+@attention  上层调用SetVout或SetCode设定带小数位的目标DAC数据，定时器中断调用Tick（或DMA回填时调用Fill）
+            以远高于输出带宽的频率输出整形后的DAC数据序列，经后级低通滤波后平均输出即为目标值。
+
+            （1）一阶整形的噪声传递函数为(1 - z^-1)，二阶为(1 - z^-1)^2，量化噪声被推向高频；
+            （2）中断中只使用32位整数运算，小数位数frac_bits最大为DAC80501_DITHER_MAX_FRAC；
+            （3）目标值与量程打包为一个32位字写入，中断读取时不会得到不一致的量程和目标值；
+            （4）目标值距离0或满量程不足2LSB时，整形序列会被限幅，平均输出的误差随之增大；
+            （5）单精度运算时SetVout以双精度换算目标值，以保留全部小数位。
+*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//引入系统头文件
+#include <stdint.h>
+#include "dac80501_spi.h"
+
+//最大小数位数
+#define DAC80501_DITHER_MAX_FRAC 12
+
+typedef struct _dac80501_dither_t dac80501_dither_t;
+
+struct _dac80501_dither_t
+{
+    //以下成员由驱动内部维护，禁止直接修改
+    dac80501_t*         dev;        //绑定的DAC80501设备
+    uint8_t             order;      //整形阶数，1或2
+    uint8_t             frac_bits;  //目标DAC数据的小数位数
+    volatile uint32_t   setpoint;   //低30位为目标DAC数据（含小数位），高2位为量程
+    uint8_t             range;      //当前使用的量程
+    int32_t             e1, e2;     //前两次的量化误差，含小数位
+    int32_t             last;       //最后一次写入的DAC数据，为-1时表示尚未写入
+
+    //操作接口
+
+    /*
+        初始化抖动模块
+        dev: 已初始化的DAC80501设备
+        order: 整形阶数，只能为1或2
+        frac_bits: 目标DAC数据的小数位数，取值1~DAC80501_DITHER_MAX_FRAC
+    */
+    DAC80501_Error (* Init)(dac80501_dither_t* dither, dac80501_t* dev, const uint8_t order, const uint8_t frac_bits);
+
+    /*
+        以电压设定目标值，量程选择规则与SetDacOut一致
+        vout: 期望输出的电压
+    */
+    DAC80501_Error (* SetVout)(dac80501_dither_t* dither, const DAC80501_Volt vout);
+
+    /*
+        以定点数设定目标值
+        range: 量程，取值见DAC80501_Range
+        code: 该量程下的目标DAC数据，含frac_bits位小数
+    */
+    DAC80501_Error (* SetCode)(dac80501_dither_t* dither, const uint8_t range, const uint32_t code);
+
+    /*
+        生成下一个DAC数据并写入芯片，在定时器中断中调用
+        DAC数据与上一次相同时不占用SPI总线
+    */
+    DAC80501_Error (* Tick)(dac80501_dither_t* dither);
+
+    /*
+        为DMA回填生成连续的DAC数据，在当前量程下有效
+        buf: 保存DAC数据的缓冲区
+        len: 缓冲区长度
+        filled: 实际生成的数据个数
+        每次调用只使用调用时的目标值；目标值需要切换量程时会先以SetDacRangeCode直接写入
+        第一个DAC数据和GAIN寄存器（该数据不放入buf），因此调用者须等待之前的数据发送完成后再调用
+    */
+    DAC80501_Error (* Fill)(dac80501_dither_t* dither, uint16_t* buf, const uint16_t len, uint16_t* filled);
+};
+
+/*
+    给出初始化抖动模块的函数接口
+*/
+
+DAC80501_Error DAC80501_DITHER_API_INIT(dac80501_dither_t* dither);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DAC80501_DITHER_H__ */
@@ -0,0 +1,406 @@
+#include "dac80501_interp.h"
+#include "dac80501_private.h"
+
+#if DAC80501_ENABLE_INTERP
+
+/*
+    （1）定义插值器内部使用的定点格式
+*/
+
+//设定点格式：相对两倍基准电压（即最大量程满量程）的Q24定点数
+#define DAC80501_INTERP_Q       24
+
+//前向差分额外保留的小数位数，保证三次插值在一个设定周期内的累积误差远小于1LSB
+#define DAC80501_INTERP_FRAC    30
+
+//各量程满量程对应的Q24阈值，与SetDacOut的量程选择规则一致
+#define DAC80501_INTERP_Q_UNITY (1L << (DAC80501_INTERP_Q - 1))
+#define DAC80501_INTERP_Q_HALF  (1L << (DAC80501_INTERP_Q - 2))
+
+#define DAC80501_INTERP_FIFO_MASK (DAC80501_INTERP_FIFO_SIZE - 1)
+
+/*
+    （2）实现插值器内部函数
+*/
+
+//依据一段插值的最大电压选择量程
+static uint8_t Dac80501_Interp_Range(int32_t q)
+{
+    if(q > DAC80501_INTERP_Q_UNITY)
+        return DAC80501_RANGE_DOUBLE;
+    else if(q > DAC80501_INTERP_Q_HALF)
+        return DAC80501_RANGE_UNITY;
+    else
+        return DAC80501_RANGE_HALF;
+}
+
+/*
+    由缓冲区取出下一个设定点，计算新一段插值的前向差分
+    段内输出为 f(t) = a*t^3 + b*t^2 + c*t + d，t = n / ratio
+    线性插值时 a = b = 0
+    返回0表示没有新的设定点
+*/
+static uint8_t Dac80501_Interp_Load(dac80501_interp_t* interp)
+{
+    int32_t q;
+
+    if(interp->fifo_tail == interp->fifo_head)
+    {
+        //三次插值缺少后一个设定点时以最后一个设定点补齐窗口，保证输出最终到达最后一个设定点
+        if((interp->mode != DAC80501_INTERP_CUBIC) || !interp->primed || (interp->seg_end == interp->point[3]))
+            return 0;
+
+        q = interp->point[3];
+    }
+    else
+    {
+        //读到fifo_head之后再读设定点，读出设定点之后再释放该位置
+        DAC80501_MEMORY_BARRIER();
+        q = interp->fifo[interp->fifo_tail];
+        DAC80501_MEMORY_BARRIER();
+        interp->fifo_tail = (interp->fifo_tail + 1) & DAC80501_INTERP_FIFO_MASK;
+
+        //第一个设定点填满整个窗口，避免由0V开始插值
+        if(!interp->primed)
+        {
+            interp->point[1] = q;
+            interp->point[2] = q;
+            interp->point[3] = q;
+            interp->primed = 1;
+        }
+    }
+
+    //滑动设定点窗口
+    interp->point[0] = interp->point[1];
+    interp->point[1] = interp->point[2];
+    interp->point[2] = interp->point[3];
+    interp->point[3] = q;
+
+    //计算 2a、2b、2c，保持整数
+    int64_t a2, b2, c2, start, end;
+
+    if(interp->mode == DAC80501_INTERP_CUBIC)
+    {
+        int64_t p0 = interp->point[0], p1 = interp->point[1];
+        int64_t p2 = interp->point[2], p3 = interp->point[3];
+
+        a2 = -p0 + 3 * p1 - 3 * p2 + p3;
+        b2 = 2 * p0 - 5 * p1 + 4 * p2 - p3;
+        c2 = p2 - p0;
+        start = p1;
+        end = p2;
+    }
+    else
+    {
+        a2 = 0;
+        b2 = 0;
+        c2 = 2 * ((int64_t)interp->point[3] - interp->point[2]);
+        start = interp->point[2];
+        end = interp->point[3];
+    }
+
+    //前向差分：h = 1/ratio
+    //d1 = a*h^3 + b*h^2 + c*h, d2 = 6a*h^3 + 2b*h^2, d3 = 6a*h^3
+    const int64_t one = (int64_t)1 << DAC80501_INTERP_FRAC;
+    const int64_t n1 = interp->ratio;
+    const int64_t n2 = n1 * n1;
+    const int64_t n3 = n2 * n1;
+
+    interp->y  = start * one;
+    interp->d3 = (3 * a2 * one) / n3;
+    interp->d2 = interp->d3 + (b2 * one) / n2;
+    interp->d1 = (a2 * (one / 2)) / n3 + (b2 * (one / 2)) / n2 + (c2 * (one / 2)) / n1;
+    interp->seg_end = (int32_t)end;
+    interp->remain = interp->ratio;
+    interp->hold = 0;
+
+    //按该段端点的最大值选择量程，超调部分由限幅处理
+    interp->range_next = Dac80501_Interp_Range(start > end ? (int32_t)start : (int32_t)end);
+    interp->range_pending = (interp->range_next != interp->range);
+
+    return 1;
+}
+
+//将Q24电压换算为当前量程下的DAC数据
+static uint16_t Dac80501_Interp_Code(dac80501_interp_t* interp, int32_t q)
+{
+    //限幅：不小于0V，不大于两倍基准电压及DAC80501_MAX_VOUT
+    if(q < 0)
+        q = 0;
+    else if(q > interp->q_max)
+        q = interp->q_max;
+
+    //满量程为两倍基准电压的 1/4、1/2、1 倍，换算只需移位并四舍五入
+    uint8_t shift = (DAC80501_INTERP_Q - 16) - (DAC80501_RANGE_DOUBLE - interp->range);
+    uint32_t code = ((uint32_t)q + (1UL << (shift - 1))) >> shift;
+
+    return code > 0xFFFF ? 0xFFFF : (uint16_t)code;
+}
+
+//生成当前段的下一个DAC数据
+static uint16_t Dac80501_Interp_Step(dac80501_interp_t* interp)
+{
+    //当前段已结束时停在终点，不再外推
+    if(interp->remain == 0)
+        return Dac80501_Interp_Code(interp, interp->seg_end);
+
+    int32_t q = (int32_t)(interp->y >> DAC80501_INTERP_FRAC);
+
+    interp->y  += interp->d1;
+    interp->d1 += interp->d2;
+    interp->d2 += interp->d3;
+    interp->remain--;
+
+    return Dac80501_Interp_Code(interp, q);
+}
+
+//没有新的设定点时停在最后一段的终点
+static uint16_t Dac80501_Interp_Hold(dac80501_interp_t* interp)
+{
+    interp->y  = (int64_t)interp->seg_end << DAC80501_INTERP_FRAC;
+    interp->d1 = 0;
+    interp->d2 = 0;
+    interp->d3 = 0;
+    interp->hold = 1;
+
+    return Dac80501_Interp_Code(interp, interp->seg_end);
+}
+
+
+/*
+    （3）实现提供给用户调用的应用层接口
+*/
+
+/*
+    清空所有设定点，输出保持当前值，更改基准电压后必须调用
+*/
+static DAC80501_Error Dac80501_Interp_Reset(dac80501_interp_t* interp)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若插值器或设备不存在，直接返回
+    CHECK_PTR(interp, error, dev);
+    CHECK_PTR(interp->dev, error, dev);
+
+    DAC80501_Volt ref_volt;
+    error = interp->dev->GetRefVolt(interp->dev, &ref_volt);
+    if(error.data)
+        return error;
+
+    error = interp->dev->GetDacRange(interp->dev, &interp->range);
+    if(error.data)
+        return error;
+
+    //输出上限取两倍基准电压与DAC80501_MAX_VOUT中的较小值
+    DAC80501_Volt vmax = 2 * ref_volt;
+    if(vmax > DAC80501_VOUT_LIMIT)
+        interp->q_max = (int32_t)Dac80501_Scale(DAC80501_VOUT_LIMIT, vmax, DAC80501_INTERP_Q);
+    else
+        interp->q_max = 1L << DAC80501_INTERP_Q;
+
+    interp->fifo_head = 0;
+    interp->fifo_tail = 0;
+    interp->primed = 0;
+    interp->remain = 0;
+    interp->hold = 1;
+    interp->range_pending = 0;
+
+    return error;
+}
+
+/*
+    初始化插值器
+*/
+static DAC80501_Error Dac80501_Interp_Init(dac80501_interp_t* interp, dac80501_t* dev, const uint8_t mode, const uint16_t ratio)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若插值器或设备不存在，直接返回
+    CHECK_PTR(interp, error, dev);
+    CHECK_PTR(dev, error, dev);
+
+    //若插值方式或上采样倍数非法，直接返回
+    if((mode > DAC80501_INTERP_CUBIC) || (ratio == 0))
+    {
+        error.param = 1;
+		DAC80501_PRINT_DEBUG("The interp mode(%d) or ratio(%d) is illegal.\n", mode, ratio);
+        return error;
+    }
+
+    interp->dev   = dev;
+    interp->mode  = mode;
+    interp->ratio = ratio;
+
+    return interp->Reset(interp);
+}
+
+/*
+    写入新的设定点
+*/
+static DAC80501_Error Dac80501_Interp_Push(dac80501_interp_t* interp, const DAC80501_Volt vout)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若插值器或设备不存在，直接返回
+    CHECK_PTR(interp, error, dev);
+    CHECK_PTR(interp->dev, error, dev);
+
+    DAC80501_Volt ref_volt;
+    error = interp->dev->GetRefVolt(interp->dev, &ref_volt);
+    if(error.data)
+        return error;
+
+    //设定电压超出可输出范围，或基准电压为0V，直接返回
+    if((vout < 0) || (vout > DAC80501_VOUT_LIMIT) || (vout > 2 * ref_volt) || (ref_volt <= 0))
+    {
+        error.out_volt = 1;
+		DAC80501_PRINT_DEBUG("The expected voltage(%lfV) is out of 0V~%lfV or bigger than %lfV\n",
+		DAC80501_PRINT_VOLT(vout), DAC80501_MAX_VOUT, DAC80501_PRINT_VOLT(2 * ref_volt));
+        return error;
+    }
+
+    //缓冲区已满，说明中断没有及时取走设定点
+    uint8_t next = (interp->fifo_head + 1) & DAC80501_INTERP_FIFO_MASK;
+    if(next == interp->fifo_tail)
+    {
+        error.overflow = 1;
+		DAC80501_PRINT_DEBUG("The interp fifo is full.\n");
+        return error;
+    }
+
+    //换算为Q24定点数，此后的插值全部为整数运算
+    int32_t q = (int32_t)Dac80501_Scale(vout, 2 * ref_volt, DAC80501_INTERP_Q);
+
+    //设定点写入完成之后才移动fifo_head，中断不会读到旧的设定点
+    interp->fifo[interp->fifo_head] = q;
+    DAC80501_MEMORY_BARRIER();
+    interp->fifo_head = next;
+
+    return error;
+}
+
+/*
+    生成下一个DAC数据并写入芯片
+*/
+static DAC80501_Error Dac80501_Interp_Tick(dac80501_interp_t* interp)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若插值器或设备不存在，直接返回
+    CHECK_PTR(interp, error, dev);
+    CHECK_PTR(interp->dev, error, dev);
+
+    uint16_t code;
+
+    if((interp->remain == 0) && !Dac80501_Interp_Load(interp))
+    {
+        //已停在终点，不再占用总线
+        if(interp->hold)
+            return error;
+
+        code = Dac80501_Interp_Hold(interp);
+        return interp->dev->SetDacCode(interp->dev, code);
+    }
+
+    //新的一段需要切换量程，量程与该段第一个DAC数据一起写入，避免中间输出超调
+    if(interp->range_pending)
+    {
+        interp->range = interp->range_next;
+        interp->range_pending = 0;
+
+        code = Dac80501_Interp_Step(interp);
+
+        return interp->dev->SetDacRangeCode(interp->dev, interp->range, code);
+    }
+
+    code = Dac80501_Interp_Step(interp);
+
+    return interp->dev->SetDacCode(interp->dev, code);
+}
+
+/*
+    为DMA回填生成连续的DAC数据
+*/
+static DAC80501_Error Dac80501_Interp_Fill(dac80501_interp_t* interp, uint16_t* buf, const uint16_t len, uint16_t* filled)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若插值器、设备或缓冲区不存在，直接返回
+    CHECK_PTR(interp, error, dev);
+    CHECK_PTR(interp->dev, error, dev);
+    CHECK_PTR(buf, error, param);
+    CHECK_PTR(filled, error, param);
+
+    uint16_t n = 0;
+
+    while(n < len)
+    {
+        //没有新的设定点时以终点补齐，保证DMA刷新频率不变
+        if((interp->remain == 0) && !Dac80501_Interp_Load(interp))
+        {
+            //尚未写入过设定点，没有可输出的数据
+            if(!interp->primed)
+                break;
+
+            uint16_t code = interp->hold ? Dac80501_Interp_Code(interp, interp->seg_end) : Dac80501_Interp_Hold(interp);
+
+            while(n < len)
+                buf[n++] = code;
+            break;
+        }
+
+        //新的一段需要切换量程，此时该段尚未生成任何DAC数据
+        if(interp->range_pending)
+        {
+            //缓冲区中已有当前量程下的数据，切换量程留待下一次调用
+            if(n)
+                break;
+
+            //该段第一个DAC数据与量程一起直接写入，避免中间输出超调
+            interp->range = interp->range_next;
+            interp->range_pending = 0;
+
+            error = interp->dev->SetDacRangeCode(interp->dev, interp->range, Dac80501_Interp_Step(interp));
+            if(error.data)
+                break;
+
+            continue;
+        }
+
+        buf[n++] = Dac80501_Interp_Step(interp);
+    }
+
+    *filled = n;
+
+    return error;
+}
+
+
+/*
+    （4）给出初始化插值器的函数接口
+*/
+
+DAC80501_Error DAC80501_INTERP_API_INIT(dac80501_interp_t* interp)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若插值器不存在，直接返回
+    CHECK_PTR(interp, error, dev);
+
+    //绑定函数接口
+    interp->Init    = Dac80501_Interp_Init;
+    interp->Reset   = Dac80501_Interp_Reset;
+    interp->Push    = Dac80501_Interp_Push;
+    interp->Tick    = Dac80501_Interp_Tick;
+    interp->Fill    = Dac80501_Interp_Fill;
+
+    return error;
+}
+
+#endif /* DAC80501_ENABLE_INTERP */
@@ -0,0 +1,120 @@
+#ifndef __DAC80501_INTERP_H__
+#define __DAC80501_INTERP_H__
+/*
+@filename   dac80501_interp.h
+
+@brief		DAC80501稀疏设定点插值上采样模块头文件
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    1.0
+
+@attention  上层控制环以较低频率（如1kHz）调用Push写入设定电压，定时器中断调用Tick（或DMA
+            回填时调用Fill）以较高频率（如50~100kHz）生成中间DAC数据。
+
+            （1）设定电压在Push时一次性换算为相对两倍基准电压的Q24定点数，中断中只使用整数运算；
+            （2）线性插值由上一个设定点过渡到最新设定点，延迟一个设定周期；
+                 三次插值采用Catmull-Rom样条，需要后一个设定点，延迟两个设定周期；
+            （3）每段插值开始时按该段端点的最大值选择量程，选择规则与SetDacOut一致，
+                 仅当量程改变时才写入GAIN寄存器，段内只写DAC数据寄存器；
+            （4）更改基准电压后已写入的设定点失效，必须调用Reset后重新Push；
+            （5）Push与中断之间只通过单生产者单消费者的设定点缓冲区交接数据，Push不修改中断使用的
+                 插值状态；Reset会清空插值状态，调用时中断不能运行。
+*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//引入系统头文件
+#include <stdint.h>
+#include "dac80501_spi.h"
+
+//设定点缓冲区深度，必须为2的幂
+#define DAC80501_INTERP_FIFO_SIZE 8
+
+//插值方式
+typedef enum
+{
+    DAC80501_INTERP_LINEAR = 0, //线性插值
+    DAC80501_INTERP_CUBIC       //三次插值（Catmull-Rom样条）
+}DAC80501_InterpMode;
+
+typedef struct _dac80501_interp_t dac80501_interp_t;
+
+struct _dac80501_interp_t
+{
+    //以下成员由驱动内部维护，禁止直接修改
+    dac80501_t* dev;                        //绑定的DAC80501设备
+    uint8_t     mode;                       //插值方式
+    uint16_t    ratio;                      //每个设定周期内生成的DAC数据个数
+    int32_t     q_max;                      //输出电压上限，Q24格式
+
+    //Push先写入设定点再移动fifo_head，中断先读出设定点再移动fifo_tail，两者之间均有内存屏障
+    volatile int32_t fifo[DAC80501_INTERP_FIFO_SIZE];   //待插值的设定点，Q24格式
+    volatile uint8_t fifo_head;             //写入位置，仅由Push修改
+    volatile uint8_t fifo_tail;             //读取位置，仅由中断修改
+
+    //以下成员只由中断（Tick/Fill）修改，Reset除外
+    int32_t     point[4];                   //参与插值的设定点窗口，point[3]为最新设定点
+    uint8_t     primed;                     //设定点窗口是否已填充
+
+    int64_t     y;                          //当前输出电压，在Q24格式基础上再保留30位小数
+    int64_t     d1, d2, d3;                 //前向差分
+    int32_t     seg_end;                    //当前段的终点，Q24格式
+    uint16_t    remain;                     //当前段剩余的DAC数据个数
+    uint8_t     hold;                       //为1时表示输出已停在终点
+    uint8_t     range;                      //当前段使用的量程
+    uint8_t     range_next;                 //下一段需要的量程
+    uint8_t     range_pending;              //为1时表示下一段需要切换量程
+
+    //操作接口
+
+    /*
+        初始化插值器
+        dev: 已初始化的DAC80501设备
+        mode: 插值方式，取值见DAC80501_InterpMode
+        ratio: 上采样倍数，即输出刷新频率与设定点频率之比，不能为0
+    */
+    DAC80501_Error (* Init)(dac80501_interp_t* interp, dac80501_t* dev, const uint8_t mode, const uint16_t ratio);
+
+    /*
+        清空所有设定点，输出保持当前值，更改基准电压后必须调用
+    */
+    DAC80501_Error (* Reset)(dac80501_interp_t* interp);
+
+    /*
+        写入新的设定点，在设定点频率下调用
+        vout: 期望输出的电压，不能超出两倍基准电压及DAC80501_MAX_VOUT
+    */
+    DAC80501_Error (* Push)(dac80501_interp_t* interp, const DAC80501_Volt vout);
+
+    /*
+        生成下一个DAC数据并写入芯片，在输出刷新频率的定时器中断中调用
+        没有新的设定点时输出保持不变，且不占用SPI总线
+    */
+    DAC80501_Error (* Tick)(dac80501_interp_t* interp);
+
+    /*
+        为DMA回填生成连续的DAC数据，在当前量程下有效
+        buf: 保存DAC数据的缓冲区
+        len: 缓冲区长度
+        filled: 实际生成的数据个数；当下一段需要切换量程时提前返回，再次调用时会先以SetDacRangeCode
+                直接写入该段第一个DAC数据和GAIN寄存器（该数据不放入buf），
+                因此调用者须等待之前的数据发送完成后再调用
+    */
+    DAC80501_Error (* Fill)(dac80501_interp_t* interp, uint16_t* buf, const uint16_t len, uint16_t* filled);
+};
+
+/*
+    给出初始化插值器的函数接口
+*/
+
+DAC80501_Error DAC80501_INTERP_API_INIT(dac80501_interp_t* interp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DAC80501_INTERP_H__ */
@@ -0,0 +1,147 @@
+#ifndef __DAC80501_PRIVATE_H__
+#define __DAC80501_PRIVATE_H__
+/*
+@filename   dac80501_private.h
+
+@brief		DAC80501驱动各模块内部共用的寄存器列表与宏定义，仅供驱动源文件包含，用户无需包含本文件
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@attention
+
+
+*/
+#include <stddef.h>
+#include "dac80501_spi.h"
+
+//定义最大DAC值, 2^16 
+#define DAC80501_MAX_DAC_DATA 65536
+
+//定义DAC80501的寄存器列表，同时也包含其偏移地址
+typedef enum _DAC80501_RegList
+{
+    NOOP    = 0,    //空操作寄存器
+    DEVID,          //设备信息寄存器      
+    SYNC,           //同步寄存器
+    CONFIG,         //配置寄存器
+    GAIN,           //增益寄存器
+    TRIGGER,        //触发寄存器
+    STATUS = 7,     //状态寄存器
+    DAC             //DAC数据寄存器
+}DAC80501_RegList;
+
+//兼容未定义批量发送缓存深度的旧版配置文件
+#ifndef DAC80501_BATCH_SIZE
+#define DAC80501_BATCH_SIZE 8
+#endif
+
+//兼容未定义调试信息开关的旧版配置文件，默认不打印
+#ifndef DAC80501_PRINT_DEBUG_INFO
+#define DAC80501_PRINT_DEBUG_INFO 0
+#endif
+
+//为0时寄存器与配置结构体由静态存储池分配，无需提供DAC80501_MALLOC和DAC80501_FREE
+#ifndef DAC80501_USE_MALLOC
+#define DAC80501_USE_MALLOC (DAC80501_PROFILE == DAC80501_PROFILE_FULL)
+#endif
+
+//静态存储池最多可容纳的设备数
+#ifndef DAC80501_MAX_DEVICES
+#define DAC80501_MAX_DEVICES 1
+#endif
+
+//扩展模块开关，关闭后对应的源文件编译为空
+#ifndef DAC80501_ENABLE_INTERP
+#define DAC80501_ENABLE_INTERP (DAC80501_PROFILE == DAC80501_PROFILE_FULL)
+#endif
+
+#ifndef DAC80501_ENABLE_DITHER
+#define DAC80501_ENABLE_DITHER (DAC80501_PROFILE == DAC80501_PROFILE_FULL)
+#endif
+
+#ifndef DAC80501_ENABLE_CTRL
+#define DAC80501_ENABLE_CTRL (DAC80501_PROFILE == DAC80501_PROFILE_FULL)
+#endif
+
+#ifndef DAC80501_ENABLE_BULK
+#define DAC80501_ENABLE_BULK (DAC80501_PROFILE == DAC80501_PROFILE_FULL)
+#endif
+
+//spidev传输接口只能在Linux上编译
+#ifndef DAC80501_ENABLE_SPIDEV
+#define DAC80501_ENABLE_SPIDEV (!DAC80501_USE_STM32_HAL)
+#endif
+
+//芯片模型只用于主机仿真
+#ifndef DAC80501_ENABLE_SIM
+#define DAC80501_ENABLE_SIM (!DAC80501_USE_STM32_HAL)
+#endif
+
+//以DAC80501_Volt表示的内部基准电压和最大输出电压
+#define DAC80501_VREF_INTERNAL  DAC80501_VOLT(DAC80501_INTERNAL_VREF)
+#define DAC80501_VOUT_LIMIT     DAC80501_VOLT(DAC80501_MAX_VOUT)
+
+//打印调试信息
+#if DAC80501_PRINT_DEBUG_INFO
+#include <stdio.h>
+#define DAC80501_PRINT_DEBUG(fmt,args...) do{printf("file:%s(%d) func %s:\n", __FILE__,__LINE__,  __FUNCTION__);printf(fmt, ##args);}while(0)
+#else
+#define DAC80501_PRINT_DEBUG(fmt,args...) do{}while(0)
+#endif
+
+//将电压转换为以V为单位的double，仅用于打印调试信息
+#if DAC80501_MATH == DAC80501_MATH_FIXED
+#define DAC80501_PRINT_VOLT(v) ((double)(v) / 1000000.0)
+#else
+#define DAC80501_PRINT_VOLT(v) ((double)(v))
+#endif
+
+/*
+    内存屏障：屏障之前的读写完成之后，才执行屏障之后的读写
+    用于中断与线程之间以volatile下标交接数据，GCC与Clang（含ARM Compiler 6）下同时约束编译器与CPU，
+    其他编译器可在配置文件中定义为对应的指令，如CMSIS的__DMB()
+*/
+#ifndef DAC80501_MEMORY_BARRIER
+#if defined(__GNUC__) || defined(__clang__)
+#define DAC80501_MEMORY_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#else
+#define DAC80501_MEMORY_BARRIER() do{}while(0)
+#endif
+#endif
+
+//检查指针非空
+#define CHECK_PTR(ptr, param, field) do{\
+                                    if(ptr == NULL) \
+                                    { \
+                                        param.field = 1;\
+										DAC80501_PRINT_DEBUG("指针 %s 为空指针。\n", #ptr);\
+                                        return param;\
+                                    } \
+                                }while(0)
+
+/*
+    计算round(num * 2^shift / den)，num不小于0且den大于0
+    定点运算时使用64位整数，结果与浮点运算最多相差1
+*/
+#if DAC80501_MATH == DAC80501_MATH_FIXED
+static inline uint32_t Dac80501_Scale(const DAC80501_Volt num, const DAC80501_Volt den, const uint8_t shift)
+{
+    return (uint32_t)((((uint64_t)num << shift) + ((uint32_t)den >> 1)) / (uint32_t)den);
+}
+#elif DAC80501_MATH == DAC80501_MATH_FLOAT
+#include <math.h>
+static inline uint32_t Dac80501_Scale(const DAC80501_Volt num, const DAC80501_Volt den, const uint8_t shift)
+{
+    return (uint32_t)roundf((num * (float)(1UL << shift)) / den);
+}
+#else
+#include <math.h>
+static inline uint32_t Dac80501_Scale(const DAC80501_Volt num, const DAC80501_Volt den, const uint8_t shift)
+{
+    return (uint32_t)round((num * (double)(1UL << shift)) / den);
+}
+#endif
+
+#endif /* __DAC80501_PRIVATE_H__ */
@@ -0,0 +1,251 @@
+#include "dac80501_sim.h"
+#include "dac80501_private.h"
+
+#if DAC80501_ENABLE_SIM
+
+/*
+    （1）定义芯片模型使用的寄存器地址和字段
+    均按芯片手册单独定义，不使用驱动的寄存器列表，以便发现驱动中错误的寄存器地址
+*/
+
+#define DAC80501_SIM_REG_NOOP       0x00    //空操作寄存器
+#define DAC80501_SIM_REG_DEVID      0x01    //设备信息寄存器，只读
+#define DAC80501_SIM_REG_SYNC       0x02    //同步寄存器
+#define DAC80501_SIM_REG_CONFIG     0x03    //配置寄存器
+#define DAC80501_SIM_REG_GAIN       0x04    //增益寄存器
+#define DAC80501_SIM_REG_TRIGGER    0x05    //触发寄存器
+#define DAC80501_SIM_REG_STATUS     0x07    //状态寄存器，只读
+#define DAC80501_SIM_REG_DAC        0x08    //DAC数据寄存器
+
+#define DAC80501_SIM_SYNC_EN        0x0001  //SYNC寄存器的DAC_SYNC_EN字段
+#define DAC80501_SIM_DAC_PWDWN      0x0001  //CONFIG寄存器的DAC_PWDWN字段
+#define DAC80501_SIM_REF_PWDWN      0x0100  //CONFIG寄存器的REF_PWDWN字段
+#define DAC80501_SIM_BUFF_GAIN      0x0001  //GAIN寄存器的BUFF_GAIN字段
+#define DAC80501_SIM_REF_DIV        0x0100  //GAIN寄存器的REF_DIV字段
+#define DAC80501_SIM_SOFT_RESET     0x000F  //TRIGGER寄存器的SOFT_RESET字段
+#define DAC80501_SIM_LDAC           0x0010  //TRIGGER寄存器的LDAC字段
+
+//软重置命令码
+#define DAC80501_SIM_RESET_CODE     0x000A
+
+
+/*
+    （2）实现芯片模型内部函数
+*/
+
+//寄存器恢复为上电状态
+static void Dac80501_Sim_Reset(dac80501_sim_t* sim)
+{
+    sim->sync       = 0;
+    sim->config     = 0;
+    sim->gain       = DAC80501_SIM_BUFF_GAIN;
+    sim->dac        = 0;
+    sim->dac_active = 0;
+}
+
+//依据寄存器计算输出电压
+static double Dac80501_Sim_Vout(const dac80501_sim_t* sim)
+{
+    //DAC关断时输出经内部电阻接地
+    if(sim->config & DAC80501_SIM_DAC_PWDWN)
+        return 0;
+
+    double vout = (sim->config & DAC80501_SIM_REF_PWDWN) ? sim->ext_ref : DAC80501_INTERNAL_VREF;
+
+    if(sim->gain & DAC80501_SIM_REF_DIV)
+        vout /= 2;
+
+    if(sim->gain & DAC80501_SIM_BUFF_GAIN)
+        vout *= 2;
+
+    //按芯片手册，VOUT = DAC_DATA / 2^16 × VREF × 增益
+    return (vout * sim->dac_active) / 65536;
+}
+
+//解码一帧数据
+static void Dac80501_Sim_Frame(dac80501_sim_t* sim, const uint8_t* frame)
+{
+    uint16_t data = (frame[1] << 8) | frame[2];
+
+    switch(frame[0])
+    {
+        case DAC80501_SIM_REG_NOOP:
+            break;
+
+        case DAC80501_SIM_REG_SYNC:
+            sim->sync = data;
+            break;
+
+        case DAC80501_SIM_REG_CONFIG:
+            sim->config = data;
+            break;
+
+        case DAC80501_SIM_REG_GAIN:
+            sim->gain = data;
+            break;
+
+        case DAC80501_SIM_REG_TRIGGER:
+            if((data & DAC80501_SIM_SOFT_RESET) == DAC80501_SIM_RESET_CODE)
+            {
+                Dac80501_Sim_Reset(sim);
+                sim->resets++;
+            }
+            //同步模式下LDAC触发使缓存的DAC数据生效
+            else if((data & DAC80501_SIM_LDAC) && (sim->sync & DAC80501_SIM_SYNC_EN))
+                sim->dac_active = sim->dac;
+            break;
+
+        case DAC80501_SIM_REG_DAC:
+            sim->dac = data;
+
+            //异步模式下立即生效
+            if(!(sim->sync & DAC80501_SIM_SYNC_EN))
+                sim->dac_active = data;
+            break;
+
+        //只读寄存器和无效地址
+        default:
+            sim->bad_frames++;
+            break;
+    }
+
+    sim->frames++;
+
+    double vout = Dac80501_Sim_Vout(sim);
+    if(vout > sim->vout_peak)
+        sim->vout_peak = vout;
+}
+
+
+/*
+    （3）实现传输接口
+*/
+
+//逐帧解码count帧数据
+static DAC80501_Error Dac80501_Sim_Write(void* handle, const uint8_t* frames, const uint16_t count)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    dac80501_sim_t* sim = (dac80501_sim_t*)handle;
+
+    //若芯片模型或数据帧不存在，直接返回
+    CHECK_PTR(sim, error, spi);
+    CHECK_PTR(frames, error, spi);
+
+    sim->writes++;
+
+    for(uint16_t i=0; i<count; i++)
+        Dac80501_Sim_Frame(sim, &frames[i * 3]);
+
+    return error;
+}
+
+
+/*
+    （4）实现提供给用户调用的应用层接口
+*/
+
+/*
+    清零统计信息
+*/
+static DAC80501_Error Dac80501_Sim_ClearStats(dac80501_sim_t* sim)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若芯片模型不存在，直接返回
+    CHECK_PTR(sim, error, dev);
+
+    sim->writes     = 0;
+    sim->frames     = 0;
+    sim->resets     = 0;
+    sim->bad_frames = 0;
+    sim->vout_peak  = Dac80501_Sim_Vout(sim);
+
+    return error;
+}
+
+/*
+    初始化芯片模型
+*/
+static DAC80501_Error Dac80501_Sim_Init(dac80501_sim_t* sim, const double ext_ref)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若芯片模型不存在，直接返回
+    CHECK_PTR(sim, error, dev);
+
+    //若外部基准电压非法，直接返回
+    if(!((ext_ref >= 0) && (ext_ref <= DAC80501_MAX_VOUT)))
+    {
+        error.ref_volt = 1;
+		DAC80501_PRINT_DEBUG("The ext_ref(%lfV) is out of 0V~%lfV.\n", ext_ref, DAC80501_MAX_VOUT);
+        return error;
+    }
+
+    sim->ext_ref = ext_ref;
+    Dac80501_Sim_Reset(sim);
+
+    return Dac80501_Sim_ClearStats(sim);
+}
+
+/*
+    获取传输接口
+*/
+static DAC80501_Error Dac80501_Sim_GetTransport(dac80501_sim_t* sim, DAC80501_Transport* transport)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若芯片模型或传输接口不存在，直接返回
+    CHECK_PTR(sim, error, dev);
+    CHECK_PTR(transport, error, spi);
+
+    transport->handle = sim;
+    transport->Write  = Dac80501_Sim_Write;
+
+    return error;
+}
+
+/*
+    获取当前输出电压
+*/
+static DAC80501_Error Dac80501_Sim_GetVout(dac80501_sim_t* sim, double* vout)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若芯片模型或输出指针不存在，直接返回
+    CHECK_PTR(sim, error, dev);
+    CHECK_PTR(vout, error, param);
+
+    *vout = Dac80501_Sim_Vout(sim);
+
+    return error;
+}
+
+
+/*
+    （5）给出初始化芯片模型的函数接口
+*/
+
+DAC80501_Error DAC80501_SIM_API_INIT(dac80501_sim_t* sim)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若芯片模型不存在，直接返回
+    CHECK_PTR(sim, error, dev);
+
+    //绑定函数接口
+    sim->Init           = Dac80501_Sim_Init;
+    sim->GetTransport   = Dac80501_Sim_GetTransport;
+    sim->GetVout        = Dac80501_Sim_GetVout;
+    sim->ClearStats     = Dac80501_Sim_ClearStats;
+
+    return error;
+}
+
+#endif /* DAC80501_ENABLE_SIM */
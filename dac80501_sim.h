@@ -0,0 +1,85 @@
+#ifndef __DAC80501_SIM_H__
+#define __DAC80501_SIM_H__
+/*
+@filename   dac80501_sim.h
+
+@brief		DAC80501芯片模型及其传输接口头文件，用于在主机上不依赖硬件运行驱动
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    1.0
+
+@attention  芯片模型按芯片手册解码每一帧数据并更新寄存器和输出电压，可直接作为InitTransport的传输接口，
+            用于在主机上以大量虚拟通道验证驱动的功能、输出误差和总线开销。
+
+            （1）上电和软重置后的寄存器值与驱动的假设一致：DAC数据为0（Z后缀型号），GAIN寄存器为1；
+            （2）同步模式（DAC_SYNC_EN为1）下写入DAC数据不改变输出，LDAC触发后才生效；
+            （3）使用外部基准源（REF_PWDWN为1）时以Init给出的外部基准电压计算输出电压；
+            （4）芯片模型不使用任何全局变量，不同的芯片模型可在不同线程中同时使用，
+                 但同一个芯片模型及其绑定的设备只能在一个线程中使用。
+*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//引入系统头文件
+#include <stdint.h>
+#include "dac80501_spi.h"
+
+typedef struct _dac80501_sim_t dac80501_sim_t;
+
+struct _dac80501_sim_t
+{
+    //以下成员由芯片模型内部维护，禁止直接修改
+    uint16_t    sync;           //SYNC寄存器
+    uint16_t    config;         //CONFIG寄存器
+    uint16_t    gain;           //GAIN寄存器
+    uint16_t    dac;            //DAC数据寄存器（缓存）
+    uint16_t    dac_active;     //实际用于输出的DAC数据
+    double      ext_ref;        //外部基准电压，单位V
+
+    //统计信息，由ClearStats清零
+    uint32_t    writes;         //传输接口的调用次数
+    uint32_t    frames;         //收到的数据帧数
+    uint32_t    resets;         //收到的软重置命令数
+    uint32_t    bad_frames;     //寄存器地址无效或只读的数据帧数
+    double      vout_peak;      //每帧之后输出电压的最大值，单位V
+
+    //操作接口
+
+    /*
+        初始化芯片模型，寄存器恢复为上电状态，统计信息清零
+        ext_ref: 外部基准电压，单位V；只使用内部基准源时可为0
+    */
+    DAC80501_Error (* Init)(dac80501_sim_t* sim, const double ext_ref);
+
+    /*
+        获取传输接口，可直接传给dac80501_t的InitTransport
+    */
+    DAC80501_Error (* GetTransport)(dac80501_sim_t* sim, DAC80501_Transport* transport);
+
+    /*
+        获取当前输出电压
+        vout: 用于保存输出电压的指针，单位V
+    */
+    DAC80501_Error (* GetVout)(dac80501_sim_t* sim, double* vout);
+
+    /*
+        清零统计信息，vout_peak置为当前输出电压
+    */
+    DAC80501_Error (* ClearStats)(dac80501_sim_t* sim);
+};
+
+/*
+    给出初始化芯片模型的函数接口
+*/
+
+DAC80501_Error DAC80501_SIM_API_INIT(dac80501_sim_t* sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DAC80501_SIM_H__ */
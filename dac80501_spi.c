@@ -1,47 +1,16 @@
 #include <stdio.h>
 #include <stdlib.h>
-#include <math.h>
+#include <string.h>
+#include <stddef.h>
 #include "dac80501_spi.h"
 #include "dac80501_spi_conf.h"
+#include "dac80501_private.h"
 
 /*
     （1）定义关于dac80501的寄存器信息
     注意，寄存器定义用到了位域，其地址分布与芯片手册的顺序相反
 */
 
-//打印调试信息
-#ifdef DAC80501_PRINT_DEBUG_INFO 
-#define DAC80501_PRINT_DEBUG(fmt,args...) do{printf("file:%s(%d) func %s:\n", __FILE__,__LINE__,  __FUNCTION__);printf(fmt, ##args);}while(0)
-#else
-#define DAC80501_PRINT_DEBUG(fmt,args...) 
-#endif
-
-//检查指针非空
-#define CHECK_PTR(ptr, param, field) do{\
-                                    if(ptr == NULL) \
-                                    { \
-                                        param.field = 1;\
-										DAC80501_PRINT_DEBUG("指针 %s 为空指针。\n", #ptr);\
-                                        return param;\
-                                    } \
-                                }while(0)
-
-//定义最大DAC值, 2^16 
-#define DAC80501_MAX_DAC_DATA 65536
-
-//定义DAC80501的寄存器列表，同时也包含其偏移地址
-typedef enum _DAC80501_RegList
-{
-    NOOP    = 0,    //空操作寄存器
-    DEVID,          //设备信息寄存器      
-    SYNC,           //同步寄存器
-    CONFIG,         //配置寄存器
-    GAIN,           //增益寄存器
-    TRIGGER,        //触发寄存器
-    STATUS = 7,     //状态寄存器
-    DAC             //DAC数据寄存器
-}DAC80501_RegList;
-
 //NOOP寄存器结构体字段描述
 union _DAC80501_Reg_NOOP
 {
@@ -149,16 +118,52 @@ union _DAC80501_Reg_DAC
 struct _DAC80501_Option
 {
 	//参考电压数组
-    double ref_volt[3];
+    DAC80501_Volt ref_volt[3];
 	
 	//期望输出电压
-	double vout_set;
+	DAC80501_Volt vout_set;
+	
+	//为1时表示DAC数据寄存器被直接写入，vout_set需要依据寄存器值重新计算
+	uint8_t vout_dirty;
+	
+	//批量发送时缓存的数据帧
+	uint8_t batch_frames[DAC80501_BATCH_SIZE * 3];
+	uint8_t batch_count;    //已缓存的帧数
+	uint8_t batch_depth;    //BeginBatch的嵌套层数，为0时不缓存
+	
+	//基准电压版本，每次绑定设备或更改参考电压数组时取新值，用于判断预编码的句柄是否失效
+	uint32_t ref_gen;
 };
 
 //定义DAC80501内部寄存器的配置常量
 
 #define TRIGGER_SOFT_RESET  0B1010   //  重置命令码
 
+//热启动快照的标识
+#define DAC80501_SNAPSHOT_MAGIC 0x44415835UL
+
+//获取当前量程，即当前满量程电压在参考电压数组中的下标
+#define DAC80501_CUR_RANGE(dev) ((!(dev)->gain->ref_div) + (dev)->gain->buff_gain)
+
+#if !DAC80501_USE_MALLOC
+//静态分配时每个设备占用的存储空间
+typedef struct
+{
+    dac80501_t*             owner;  //占用该存储空间的设备，为NULL时空闲
+    DAC80501_Reg_SYNC       sync;
+    DAC80501_Reg_CONFIG     config;
+    DAC80501_Reg_GAIN       gain;
+    DAC80501_Reg_TRIGGER    trigger;
+    DAC80501_Reg_DAC        dac;
+    DAC80501_Option         option;
+}DAC80501_Storage;
+
+static DAC80501_Storage dac80501_storage[DAC80501_MAX_DEVICES];
+#endif
+
+//所有设备共用的基准电压版本计数器，设备反初始化后重新初始化时版本号也不会重复
+static uint32_t dac80501_ref_gen = 0;
+
 
 /*
     （2）实现对DAC880501的底层通信
@@ -166,112 +171,59 @@ struct _DAC80501_Option
 */
 
 
+#if DAC80501_USE_STM32_HAL
+
 //控制SYNC#信号
 #define ENABLE_SYNC(dev)    do{HAL_GPIO_WritePin(dev->sync_GPIO, dev->sync_BIT, 0);DAC80501_DELAY_1US;}while(0)
 #define DISABLE_SYNC(dev)   do{HAL_GPIO_WritePin(dev->sync_GPIO, dev->sync_BIT, 1);DAC80501_DELAY_1US;}while(0)
 
-
-static DAC80501_Error Dac80501_SPI_Write(dac80501_t* dev, DAC80501_RegList reg, uint16_t data);
-
-static DAC80501_Error Dac80501_SPI_Write(dac80501_t* dev, DAC80501_RegList reg, uint16_t data)
+//基于STM32 HAL库的传输接口，handle为设备描述符，每帧数据单独产生SYNC#信号
+static DAC80501_Error Dac80501_HAL_Write(void* handle, const uint8_t* frames, const uint16_t count)
 {
     DAC80501_Error error;
     error.data = 0;
     
+    dac80501_t* dev = (dac80501_t*)handle;
+    
     //若设备不存在，直接返回
     CHECK_PTR(dev, error, dev);
     
     //若设备没有绑定SPI接口, 直接返回
     CHECK_PTR(dev->hspi, error, spi);
     
-    //发送数据
-    uint8_t send_data[3] = {(uint8_t)reg, (data>>8) & 0xFF, data&0xFF};
-    
-    ENABLE_SYNC(dev);
-    HAL_SPI_Transmit(dev->hspi, send_data, 3, HAL_MAX_DELAY);
-    DISABLE_SYNC(dev);
+    for(uint16_t i=0; i<count; i++)
+    {
+        ENABLE_SYNC(dev);
+        if(HAL_SPI_Transmit(dev->hspi, (uint8_t*)&frames[i * 3], 3, HAL_MAX_DELAY) != HAL_OK)
+            error.spi = 1;
+        DISABLE_SYNC(dev);
+        
+        if(error.data)
+            break;
+    }
     
     return error;
 }
 
+#endif
 
-
-/*
-    （3）实现提供给用户调用的应用层接口
-*/
-
-/*
-    初始化DAC80501, 
-    注意该函数绑定spi接口，但并不负责初始化对应的SPI接口
-*/
-static DAC80501_Error  DAC80501_Init(dac80501_t* dev, SPI_HandleTypeDef *hspi, GPIO_TypeDef* sync_GPIO, const uint16_t sync_BIT, 
-	double vout_default, void (*fun_callback)(void))
+//将缓存的数据帧一次提交给传输接口
+static DAC80501_Error Dac80501_SPI_Flush(dac80501_t* dev)
 {
     DAC80501_Error error;
     error.data = 0;
     
-    //若设备不存在，直接返回
-    CHECK_PTR(dev, error, dev);
-    
-    //若设备没有绑定SPI接口, 直接返回
-    CHECK_PTR(hspi, error, spi);
-    
-    //如果SYNC#信号线无效，直接返回
-    CHECK_PTR(sync_GPIO, error, sync);
-	
-	//如果默认输出电压小于0V或者大于内部基准电压的2倍，则报错
-	if((vout_default > 2 * DAC80501_INTERNAL_VREF) || (vout_default < 0))
-	{
-		DAC80501_PRINT_DEBUG("The default vout(%lfV) is illegal.", vout_default);
-		error.out_volt = 1;
-		return error;
-	}	
-    
-    //为结构体成员动态申请空间
-    dev->sync   = DAC80501_MALLOC(DAC80501_Reg_SYNC);
-    CHECK_PTR(dev->sync, error, malloc);
-    
-    dev->config = DAC80501_MALLOC(DAC80501_Reg_CONFIG);
-    CHECK_PTR(dev->config, error, malloc);
-  
-    dev->gain   = DAC80501_MALLOC(DAC80501_Reg_GAIN);
-    CHECK_PTR(dev->gain, error, malloc);
-    
-    dev->trigger= DAC80501_MALLOC(DAC80501_Reg_TRIGGER);
-    CHECK_PTR(dev->trigger, error, malloc);
-    
-    dev->dac    = DAC80501_MALLOC(DAC80501_Reg_DAC);
-    CHECK_PTR(dev->dac, error, malloc);
-	
-	//为其他配置结构体申请空间
-	dev->option = DAC80501_MALLOC(DAC80501_Option);
-    CHECK_PTR(dev->option, error, malloc);
-	
-	//设置默认输出电压
-	dev->option->vout_set = vout_default;
-	
-    //绑定SYNC#信号
-    dev->sync_GPIO  = sync_GPIO;
-    dev->sync_BIT   = sync_BIT;
-    
-    //绑定SPI接口
-    dev->hspi = hspi;
-    
-    //重置芯片
-    error = dev->SoftReset(dev);
+    if(dev->option->batch_count == 0)
+        return error;
     
-    //调用回调函数，用户可在回调函数中初始化相关硬件接口
-    if(fun_callback != NULL)
-        fun_callback();
+    error = dev->transport.Write(dev->transport.handle, dev->option->batch_frames, dev->option->batch_count);
+    dev->option->batch_count = 0;
     
     return error;
 }
 
- /*
-    反初始化DAC80501, 
-    注意该函数绑定spi接口，但并不负责初始化对应的SPI接口
-*/
-static DAC80501_Error DAC80501_DeInit(dac80501_t* dev, void (*fun_callback)(void))
+//发送已编码的数据帧，批量发送中时先缓存
+static DAC80501_Error Dac80501_SPI_WriteFrames(dac80501_t* dev, const uint8_t* frames, uint16_t count)
 {
     DAC80501_Error error;
     error.data = 0;
@@ -279,210 +231,1068 @@ static DAC80501_Error DAC80501_DeInit(dac80501_t* dev, void (*fun_callback)(void
     //若设备不存在，直接返回
     CHECK_PTR(dev, error, dev);
     
-    //重置芯片
-    error = dev->SoftReset(dev);
-    
-    //释放寄存器空间
-    DAC80501_FREE(dev->sync);
-    DAC80501_FREE(dev->config);
-    DAC80501_FREE(dev->gain);
-    DAC80501_FREE(dev->trigger);
-    DAC80501_FREE(dev->dac);
-	
-	//释放配置结构体空间
-    DAC80501_FREE(dev->option);
-	
-    //先将SYNC信号失效
-    DISABLE_SYNC(dev);
-    
-    //解绑SYNC#信号
-    dev->sync_GPIO  = NULL;
-    dev->sync_BIT   = 0;
+    //若设备没有绑定传输接口, 直接返回
+    CHECK_PTR(dev->transport.Write, error, spi);
     
-    //解绑SPI接口
-    dev->hspi = NULL;
+    //不在批量发送中，直接提交
+    if(!dev->option->batch_depth)
+        return dev->transport.Write(dev->transport.handle, frames, count);
     
-    //调用回调函数，用户可在回调函数中反初始化相关硬件接口
-    if(fun_callback != NULL)
-        fun_callback();
+    for(uint16_t i=0; i<count; i++)
+    {
+        //缓存已满，先提交已缓存的数据帧
+        if(dev->option->batch_count >= DAC80501_BATCH_SIZE)
+        {
+            error = Dac80501_SPI_Flush(dev);
+            if(error.data)
+                return error;
+        }
+        
+        memcpy(&dev->option->batch_frames[dev->option->batch_count * 3], &frames[i * 3], 3);
+        dev->option->batch_count++;
+    }
     
     return error;
 }
 
-  /*
-        设置外部基准电压，注意调用该函数会自动禁用内部基准源
-    */
-static DAC80501_Error DAC80501_SetRefVolt(dac80501_t* dev, const double ref_volt)
+static DAC80501_Error Dac80501_SPI_Write(dac80501_t* dev, DAC80501_RegList reg, uint16_t data);
+
+static DAC80501_Error Dac80501_SPI_Write(dac80501_t* dev, DAC80501_RegList reg, uint16_t data)
 {
-    DAC80501_Error error;
-    error.data = 0;
-    
-    //若设备不存在，直接返回
-    CHECK_PTR(dev, error, dev);
-    
-    //若基准电压小于0，直接返回
-    if(ref_volt<0)
-    {
-        error.ref_volt = 1;
-		DAC80501_PRINT_DEBUG("The ref_volt(%lfV) is smaller than 0V.\n", ref_volt);
-        return error;
-    }
-	
-	//若基准电压大于DAC的最大供电电压，直接返回
-	if(ref_volt > DAC80501_MAX_VOUT)
-	{
-		error.ref_volt = 1;
-		DAC80501_PRINT_DEBUG("The ref_volt(%lfV) is bigger than %lfV.\n", ref_volt, DAC80501_MAX_VOUT);
-        return error;
-	}
-	
-	//基准电压就是当前设置，直接返回
-	if(ref_volt == dev->option->ref_volt[1])
-		return error;
+    //发送数据
+    uint8_t send_data[3] = {(uint8_t)reg, (data>>8) & 0xFF, data&0xFF};
     
-	//使用外部基准源
-	error = dev->SetRefPower(dev, 1);
-	
-	if(!error.data)
-	{
-		dev->option->ref_volt[0] = ref_volt / 2.0;
-		dev->option->ref_volt[1] = ref_volt;
-		dev->option->ref_volt[2] = ref_volt * 2.0;
-		
-		//更改外部基准电压后，再同步DAC寄存器的值
-		dev->SetDacOut(dev, dev->option->vout_set);
-	}
-	else
-		DAC80501_PRINT_DEBUG("Set ref_volt failed, error code is %d.\n", error.data);
-
-    return error;
+    return Dac80501_SPI_WriteFrames(dev, send_data, 1);
 }
 
+//开始批量发送
+static void Dac80501_BatchBegin(dac80501_t* dev)
+{
+    dev->option->batch_depth++;
+}
 
-/*
-    设置 SYNC 寄存器的 DAC_SYNC_EN 字段
-    enable:只有最低位有效；最低位为1时，DAC输出设置为响应LDAC触发而更新（同步模式）。
-    当为0时，DAC输出设置为立即更新（异步模式）。
-*/
-static DAC80501_Error DAC80501_SetDacSync(dac80501_t* dev, const uint8_t enable)
+//结束批量发送，最外层时提交缓存的数据帧
+static DAC80501_Error Dac80501_BatchEnd(dac80501_t* dev)
 {
     DAC80501_Error error;
     error.data = 0;
     
-    //若设备不存在，直接返回
-    CHECK_PTR(dev, error, dev);
+    if(dev->option->batch_depth)
+        dev->option->batch_depth--;
     
-    //写入数据
-    dev->sync->dac_sync_en = enable & 0x1;
-    error.data |= Dac80501_SPI_Write(dev, SYNC, dev->sync->data).data;
+    if(!dev->option->batch_depth)
+        error = Dac80501_SPI_Flush(dev);
     
     return error;
-}        
+}
 
-/*
-    设置内部基准电压源
-    disable:只有最低位有效；最低位为0时使能内部基准源。
-*/
-static DAC80501_Error DAC80501_SetRefPower(dac80501_t* dev, const uint8_t disable)
+//计算指定量程对应的GAIN寄存器值
+static uint16_t Dac80501_RangeGain(dac80501_t* dev, uint8_t range)
 {
-    DAC80501_Error error;
-    error.data = 0;
+    DAC80501_Reg_GAIN gain = *dev->gain;
     
-    //若设备不存在，直接返回
-    CHECK_PTR(dev, error, dev);
-    
-    //写入数据
-    dev->config->ref_pwdwn = disable & 0x1;
-    error.data |= Dac80501_SPI_Write(dev, CONFIG, dev->config->data).data;
-    
-    //如果启用内部基准电压源，则同步修改基准电压设置
-    if((error.data == 0) && (disable == 0))
-    {  
-		dev->option->ref_volt[0] = DAC80501_INTERNAL_VREF / 2.0;
-		dev->option->ref_volt[1] = DAC80501_INTERNAL_VREF;
-		dev->option->ref_volt[2] = DAC80501_INTERNAL_VREF * 2.0;
+    switch(range)
+    {
+        case DAC80501_RANGE_DOUBLE:
+            gain.buff_gain = 1;
+            gain.ref_div   = 0;
+            break;
+        
+        case DAC80501_RANGE_UNITY:
+            gain.buff_gain = 0;
+            gain.ref_div   = 0;
+            break;
+        
+        default:
+            gain.buff_gain = 0;
+            gain.ref_div   = 1;
+            break;
     }
-    return error;
+    
+    return gain.data;
 }
 
- /*
-    设置DAC输出
-    disable:只有最低位有效；最低位为1时，DAC处于关断模式，DAC输出通过1 kΩ内部电阻连接至GND。
-*/
-static DAC80501_Error DAC80501_SetDacPower(dac80501_t* dev, const uint8_t disable)
+//按量程写入GAIN寄存器，量程未改变时不发送数据
+static DAC80501_Error Dac80501_WriteRange(dac80501_t* dev, uint8_t range)
 {
     DAC80501_Error error;
     error.data = 0;
     
-    //若设备不存在，直接返回
-    CHECK_PTR(dev, error, dev);
+    if(DAC80501_CUR_RANGE(dev) == range)
+        return error;
     
-    //写入数据
-    dev->config->dac_pwdwn = disable & 0x1;
-    error.data |= Dac80501_SPI_Write(dev, CONFIG, dev->config->data).data;
+    dev->gain->data = Dac80501_RangeGain(dev, range);
     
-    return error;
+    return Dac80501_SPI_Write(dev, GAIN, dev->gain->data);
+}
+
+//同步模式下触发LDAC，使缓存的DAC数据生效，不改变TRIGGER寄存器中LDAC字段的设置
+static DAC80501_Error Dac80501_TriggerLdac(dac80501_t* dev)
+{
+    DAC80501_Reg_TRIGGER trigger = *dev->trigger;
+    
+    trigger.soft_reset = 0;
+    trigger.ldac = 1;
+    
+    return Dac80501_SPI_Write(dev, TRIGGER, trigger.data);
 }
 
 /*
-    设置DAC基准电压分压系数
-    div: 只能为1或2；可以将器件的基准电压（来自内部或外部基准电压源）除以div
+    按量程和DAC数据更新输出，GAIN寄存器不经过缓存，无法与DAC数据同时生效，因此按量程变化的方向排序：
+    量程变大时先写DAC数据再写GAIN，中间输出为新DAC数据乘以旧满量程；
+    量程变小时先写GAIN再写DAC数据，中间输出为旧DAC数据乘以新满量程。
+    这样唯一的中间输出不会超过起止电压中的较大值，且只要存在位于起止电压之间的中间输出，就一定是该值。
+    同步模式下量程改变时插入LDAC触发，使DAC数据在上述位置生效；量程未改变时DAC数据仍等待用户触发LDAC
 */
-static DAC80501_Error Dac80501_SetRefDiv(dac80501_t* dev, const uint8_t div)
+static DAC80501_Error Dac80501_WriteRangeCode(dac80501_t* dev, uint8_t range, uint16_t code)
 {
     DAC80501_Error error;
     error.data = 0;
     
-    //若设备不存在，直接返回
-    CHECK_PTR(dev, error, dev);
+    uint8_t cur = DAC80501_CUR_RANGE(dev);
     
-    //若div非法，直接返回
-    if((div != 1) && (div != 2))
+    //所有数据帧合并为一次提交
+    Dac80501_BatchBegin(dev);
+    
+    dev->dac->dac_data = code;
+    
+    if(range > cur)
     {
-        error.div = 1;
-		DAC80501_PRINT_DEBUG("The div is only set to 1 or 2，but this is %d\n", div);
-        return error;
+        error.data |= Dac80501_SPI_Write(dev, DAC, dev->dac->dac_data).data;
+        
+        if(dev->sync->dac_sync_en)
+            error.data |= Dac80501_TriggerLdac(dev).data;
+        
+        error.data |= Dac80501_WriteRange(dev, range).data;
+    }
+    else if(range < cur)
+    {
+        error.data |= Dac80501_WriteRange(dev, range).data;
+        error.data |= Dac80501_SPI_Write(dev, DAC, dev->dac->dac_data).data;
+        
+        if(dev->sync->dac_sync_en)
+            error.data |= Dac80501_TriggerLdac(dev).data;
     }
+    else
+        error.data |= Dac80501_SPI_Write(dev, DAC, dev->dac->dac_data).data;
     
-    //写入数据
-    dev->gain->ref_div = div - 1;
-    error.data |= Dac80501_SPI_Write(dev, GAIN, dev->gain->data).data;
+    error.data |= Dac80501_BatchEnd(dev).data;
     
     return error;
 }
 
- /*
-    设置DAC内部缓冲放大器增益
-    gain: 只能为1或2；为1时实际增益为1（即无输出增益），为2时实际增益为2。
-*/
-static DAC80501_Error Dac80501_SetBuffGain(dac80501_t* dev, const uint8_t gain)
+//更改基准电压，同步更新参考电压数组
+static void Dac80501_SetLadder(dac80501_t* dev, const DAC80501_Volt ref_volt)
+{
+    dev->option->ref_volt[0] = ref_volt / 2;
+    dev->option->ref_volt[1] = ref_volt;
+    dev->option->ref_volt[2] = ref_volt * 2;
+    dev->option->ref_gen = ++dac80501_ref_gen;
+}
+
+//检查期望输出电压在当前基准电压下是否可以输出
+static DAC80501_Error Dac80501_CheckVout(dac80501_t* dev, const DAC80501_Volt vout)
 {
     DAC80501_Error error;
     error.data = 0;
     
-    //若设备不存在，直接返回
-    CHECK_PTR(dev, error, dev);
-    
-    //若gain非法，直接返回
-    if((gain != 1) && (gain != 2))
+    //若基准电压值小于0V，直接返回
+    if(dev->option->ref_volt[1] < 0)
     {
-        error.gain = 1;
-		DAC80501_PRINT_DEBUG("The gain is only set to 1 or 2，but this is %d\n", gain);
+        error.ref_volt = 1;
+		DAC80501_PRINT_DEBUG("The ref_volt(%lfV) is smaller than 0V.\n", DAC80501_PRINT_VOLT(dev->option->ref_volt[1]));
         return error;
     }
     
-    //写入数据
-    dev->gain->buff_gain = gain - 1;
-    error.data |= Dac80501_SPI_Write(dev, GAIN, dev->gain->data).data;
+    //若设置的DAC输出电压小于0V，或大于芯片所能输出最大的输出电压
+    //或者依据当前基准电压，需要输出的电压大于实际可输出的最大电压，则返回
+    if((vout < 0) || (vout > DAC80501_VOUT_LIMIT) || (vout > dev->option->ref_volt[2]))
+    {
+        error.out_volt = 1;
+		DAC80501_PRINT_DEBUG("The expected voltage(%lfV) is out of 0V~%lfV or bigger than %lfV\n", 
+		DAC80501_PRINT_VOLT(vout), DAC80501_MAX_VOUT, DAC80501_PRINT_VOLT(dev->option->ref_volt[2]));
+        return error;
+		
+    }
     
     return error;
-}    
+}
+
+//依据期望输出电压选择量程并换算为16位DAC数据，不检查参数也不发送数据
+static void Dac80501_Encode(dac80501_t* dev, const DAC80501_Volt vout, uint8_t* range, uint16_t* code)
+{
+    //大于基准电压时分压比为1、增益为2；大于基准电压的一半时不分压也不增益；否则自动分压
+    if(vout > dev->option->ref_volt[1])
+        *range = DAC80501_RANGE_DOUBLE;
+    else if(vout > dev->option->ref_volt[0])
+        *range = DAC80501_RANGE_UNITY;
+    else
+        *range = DAC80501_RANGE_HALF;
+    
+    DAC80501_Volt vout_max = dev->option->ref_volt[*range];
+    
+    //满量程时取最大DAC数据，此时不做除法，基准电压为0V时也不会除以0
+    if(vout >= vout_max)
+    {
+        *code = DAC80501_MAX_DAC_DATA - 1;
+        return;
+    }
+    
+    uint32_t dac_data = Dac80501_Scale(vout, vout_max, 16);
+    
+    //四舍五入后超出16位的值取最大DAC数据
+    if(dac_data > DAC80501_MAX_DAC_DATA - 1)
+        *code = DAC80501_MAX_DAC_DATA - 1;
+    else
+        *code = (uint16_t)dac_data;
+}
+
+//若DAC数据寄存器被直接写入，则依据寄存器值与当前量程重新计算期望输出电压
+static void Dac80501_SyncVoutSet(dac80501_t* dev)
+{
+    if(!dev->option->vout_dirty)
+        return;
+    
+    DAC80501_Volt vout_max = dev->option->ref_volt[DAC80501_CUR_RANGE(dev)];
+    
+    if(dev->dac->dac_data == DAC80501_MAX_DAC_DATA - 1)
+        dev->option->vout_set = vout_max;
+    else
+#if DAC80501_MATH == DAC80501_MATH_FIXED
+        dev->option->vout_set = (DAC80501_Volt)(((uint64_t)dev->dac->dac_data * (uint32_t)vout_max) >> 16);
+#else
+        dev->option->vout_set = (dev->dac->dac_data * vout_max) / DAC80501_MAX_DAC_DATA;
+#endif
+    
+    dev->option->vout_dirty = 0;
+}
+
+
+
+#if DAC80501_ENABLE_SNAPSHOT
+
+//计算快照的CRC-16/CCITT校验值，不包括校验值本身
+static uint16_t Dac80501_SnapshotCrc(const DAC80501_Snapshot* snapshot)
+{
+    const uint8_t* p = (const uint8_t*)snapshot;
+    uint16_t crc = 0xFFFF;
+    
+    for(uint16_t i=0; i<offsetof(DAC80501_Snapshot, crc); i++)
+    {
+        crc ^= (uint16_t)p[i] << 8;
+        
+        for(uint8_t j=0; j<8; j++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+    }
+    
+    return crc;
+}
+
+//检查快照的完整性以及其中的基准电压和输出电压是否合法
+static uint8_t Dac80501_SnapshotValid(const DAC80501_Snapshot* snapshot)
+{
+    if(snapshot->magic != DAC80501_SNAPSHOT_MAGIC)
+        return 0;
+    
+    if(snapshot->crc != Dac80501_SnapshotCrc(snapshot))
+        return 0;
+    
+    //取反比较，同时排除NaN
+    if(!((snapshot->ref_volt >= 0) && (snapshot->ref_volt <= DAC80501_VOUT_LIMIT)))
+        return 0;
+    
+    if(!((snapshot->vout_set >= 0) && (snapshot->vout_set <= 2 * snapshot->ref_volt)))
+        return 0;
+    
+    return 1;
+}
+
+/*
+    由快照恢复寄存器与配置，并设置输出电压
+    芯片寄存器认为与快照一致，仅发送与期望输出不同的GAIN和DAC数据帧
+*/
+static DAC80501_Error Dac80501_WarmStart(dac80501_t* dev, const DAC80501_Snapshot* snapshot, DAC80501_Volt vout)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //恢复寄存器的值
+    dev->sync->data     = snapshot->sync;
+    dev->config->data   = snapshot->config;
+    dev->gain->data     = snapshot->gain;
+    dev->trigger->data  = snapshot->trigger;
+    dev->dac->data      = snapshot->dac;
+    
+    //恢复参考电压数组
+    Dac80501_SetLadder(dev, snapshot->ref_volt);
+    dev->option->vout_set = snapshot->vout_set;
+    
+    //检查期望输出电压
+    error = Dac80501_CheckVout(dev, vout);
+    if(error.data)
+        return error;
+    
+    uint8_t range;
+    uint16_t code;
+    
+    Dac80501_Encode(dev, vout, &range, &code);
+    
+    //量程和DAC数据均与快照相同时不再发送
+    if((range != DAC80501_CUR_RANGE(dev)) || (dev->dac->dac_data != code))
+        error = Dac80501_WriteRangeCode(dev, range, code);
+    
+    dev->option->vout_set = vout;
+    
+    return error;
+}
+
+#endif
+
+
+
+//释放寄存器与配置结构体的空间
+static void Dac80501_Free(dac80501_t* dev)
+{
+#if DAC80501_USE_MALLOC
+    //释放寄存器空间
+    DAC80501_FREE(dev->sync);
+    DAC80501_FREE(dev->config);
+    DAC80501_FREE(dev->gain);
+    DAC80501_FREE(dev->trigger);
+    DAC80501_FREE(dev->dac);
+	
+	//释放配置结构体空间
+    DAC80501_FREE(dev->option);
+#else
+    for(size_t i=0; i<DAC80501_MAX_DEVICES; i++)
+    {
+        if(dac80501_storage[i].owner == dev)
+            dac80501_storage[i].owner = NULL;
+    }
+    
+    dev->sync       = NULL;
+    dev->config     = NULL;
+    dev->gain       = NULL;
+    dev->trigger    = NULL;
+    dev->dac        = NULL;
+    dev->option     = NULL;
+#endif
+}
+
+//为寄存器与配置结构体分配空间
+static DAC80501_Error Dac80501_Alloc(dac80501_t* dev)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+#if DAC80501_USE_MALLOC
+    //为结构体成员动态申请空间
+    dev->sync   = DAC80501_MALLOC(DAC80501_Reg_SYNC);
+    dev->config = DAC80501_MALLOC(DAC80501_Reg_CONFIG);
+    dev->gain   = DAC80501_MALLOC(DAC80501_Reg_GAIN);
+    dev->trigger= DAC80501_MALLOC(DAC80501_Reg_TRIGGER);
+    dev->dac    = DAC80501_MALLOC(DAC80501_Reg_DAC);
+	
+	//为其他配置结构体申请空间
+	dev->option = DAC80501_MALLOC(DAC80501_Option);
+    
+    //任一空间申请失败时释放已申请的空间，避免内存泄漏
+    if((dev->sync == NULL) || (dev->config == NULL) || (dev->gain == NULL) ||
+       (dev->trigger == NULL) || (dev->dac == NULL) || (dev->option == NULL))
+    {
+        Dac80501_Free(dev);
+        error.malloc = 1;
+        DAC80501_PRINT_DEBUG("Malloc failed.\n");
+        return error;
+    }
+#else
+    DAC80501_Storage* storage = NULL;
+    
+    //重复初始化时沿用该设备已占用的存储空间，否则取第一个空闲的存储空间
+    for(size_t i=0; i<DAC80501_MAX_DEVICES; i++)
+    {
+        if(dac80501_storage[i].owner == dev)
+        {
+            storage = &dac80501_storage[i];
+            break;
+        }
+        
+        if((storage == NULL) && (dac80501_storage[i].owner == NULL))
+            storage = &dac80501_storage[i];
+    }
+    
+    CHECK_PTR(storage, error, malloc);
+    
+    storage->owner  = dev;
+    dev->sync       = &storage->sync;
+    dev->config     = &storage->config;
+    dev->gain       = &storage->gain;
+    dev->trigger    = &storage->trigger;
+    dev->dac        = &storage->dac;
+    dev->option     = &storage->option;
+#endif
+    
+    //寄存器初值清零，软重置时TRIGGER寄存器除复位字段外的其他字段不能为随机值
+    dev->sync->data     = 0;
+    dev->config->data   = 0;
+    dev->gain->data     = 0;
+    dev->trigger->data  = 0;
+    dev->dac->data      = 0;
+    
+    return error;
+}
+
+
+
+//复位以后需要至少延时1ms等待期间复位完成，这里延时1ms
+static void Dac80501_ResetDelay(void)
+{
+    for(uint32_t i=0; i<1000; i++)
+        DAC80501_DELAY_1US;
+}
+
+//发送软重置命令并同步更新寄存器的值，不等待复位完成
+static DAC80501_Error Dac80501_ResetSend(dac80501_t* dev)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //复位前先确定当前实际输出的电压，以便复位后恢复
+    Dac80501_SyncVoutSet(dev);
+    
+    //写入数据
+    dev->trigger->soft_reset = TRIGGER_SOFT_RESET;
+    error = Dac80501_SPI_Write(dev, TRIGGER, dev->trigger->data);
+    
+    //同步更新寄存器的值
+    if(!error.data)
+    {
+        //设置参考电压为内部基准电压
+		Dac80501_SetLadder(dev, DAC80501_VREF_INTERNAL);
+        
+        //重置寄存器参数
+        dev->sync->data = 0;
+        dev->config->data = 0;
+        dev->gain->data = 1;
+        dev->trigger->data = 0;
+        dev->dac->data = 0; //由于SPI模式无法读取芯片型号，这里暂时默认为0
+    }
+    
+    return error;
+}
+
+//判断设备是否可以由快照热启动
+static uint8_t Dac80501_WarmReady(dac80501_t* dev)
+{
+#if DAC80501_ENABLE_SNAPSHOT
+    return (dev->warm_snapshot != NULL) && Dac80501_SnapshotValid(dev->warm_snapshot);
+#else
+    (void)dev;
+    return 0;
+#endif
+}
+
+//检查默认输出电压，小于0V或者大于内部基准电压的2倍时报错
+static DAC80501_Error Dac80501_CheckDefault(DAC80501_Volt vout_default)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    if((vout_default > 2 * DAC80501_VREF_INTERNAL) || (vout_default < 0))
+    {
+        DAC80501_PRINT_DEBUG("The default vout(%lfV) is illegal.", DAC80501_PRINT_VOLT(vout_default));
+        error.out_volt = 1;
+    }
+    
+    return error;
+}
+
+/*
+    为设备分配空间并绑定传输接口，不发送数据
+*/
+static DAC80501_Error Dac80501_Bind(dac80501_t* dev, const DAC80501_Transport* transport, DAC80501_Volt vout_default)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //如果默认输出电压非法，则报错
+    error = Dac80501_CheckDefault(vout_default);
+    if(error.data)
+        return error;
+    
+    //为寄存器与配置结构体分配空间
+    error = Dac80501_Alloc(dev);
+    if(error.data)
+        return error;
+    
+    //设置默认输出电压
+    dev->option->vout_set = vout_default;
+    dev->option->vout_dirty = 0;
+    
+    //初始时不处于批量发送中
+    dev->option->batch_count = 0;
+    dev->option->batch_depth = 0;
+    
+    //取新的基准电压版本，反初始化前预编码的句柄不会与重新初始化后的设备匹配
+    dev->option->ref_gen = ++dac80501_ref_gen;
+    
+    //绑定传输接口
+    dev->transport = *transport;
+    
+    return error;
+}
+
+/*
+    释放设备的空间并解绑传输接口，不发送数据
+*/
+static void Dac80501_Unbind(dac80501_t* dev)
+{
+    //释放寄存器与配置结构体的空间
+    Dac80501_Free(dev);
+	
+#if DAC80501_USE_STM32_HAL
+    //解绑SYNC#信号
+    dev->sync_GPIO  = NULL;
+    dev->sync_BIT   = 0;
+    
+    //解绑SPI接口
+    dev->hspi = NULL;
+#endif
+    
+    //解绑传输接口
+    dev->transport.handle = NULL;
+    dev->transport.Write  = NULL;
+}
+
+/*
+    复位后以设置的输出电压更新DAC寄存器，各数据帧合并为一次传输接口调用
+*/
+static DAC80501_Error Dac80501_ResetRestore(dac80501_t* dev)
+{
+    DAC80501_Error error;
+    
+    Dac80501_BatchBegin(dev);
+    
+    //同步更新DAC寄存器的值，保证复位后实际输出电压为设置的输出电压
+    error = dev->SetDacOut(dev, dev->option->vout_set);
+    error.data |= Dac80501_BatchEnd(dev).data;
+    
+    return error;
+}
+
+/*
+    启动已绑定的一组设备：快照有效的设备热启动，其余设备软重置
+    所有需要软重置的设备连续发送复位命令，只等待一次复位完成时间，再依次恢复输出电压，
+    每个设备恢复输出时只调用一次传输接口
+*/
+static DAC80501_Error Dac80501_GroupStart(dac80501_t* const* devs, const uint16_t count, void (*fun_callback)(void))
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    uint16_t cold = 0;
+    
+    for(uint16_t i=0; i<count; i++)
+        cold += !Dac80501_WarmReady(devs[i]);
+    
+    //若芯片此时正在复位，保险起见先延时
+    if(cold)
+        Dac80501_ResetDelay();
+    
+    for(uint16_t i=0; i<count; i++)
+    {
+        if(!Dac80501_WarmReady(devs[i]))
+            error.data |= Dac80501_ResetSend(devs[i]).data;
+    }
+    
+    //所有设备共用一次复位完成时间
+    if(cold)
+        Dac80501_ResetDelay();
+    
+    for(uint16_t i=0; i<count; i++)
+    {
+        dac80501_t* dev = devs[i];
+        
+#if DAC80501_ENABLE_SNAPSHOT
+        //快照只使用一次，恢复输出的数据帧合并为一次传输接口调用
+        if(Dac80501_WarmReady(dev))
+        {
+            Dac80501_BatchBegin(dev);
+            error.data |= Dac80501_WarmStart(dev, dev->warm_snapshot, dev->option->vout_set).data;
+            error.data |= Dac80501_BatchEnd(dev).data;
+            dev->warm_snapshot = NULL;
+            continue;
+        }
+        
+        if(dev->warm_snapshot != NULL)
+            DAC80501_PRINT_DEBUG("The snapshot is invalid, reset the chip.\n");
+        
+        dev->warm_snapshot = NULL;
+#endif
+        
+        error.data |= Dac80501_ResetRestore(dev).data;
+    }
+    
+    //调用回调函数，用户可在回调函数中初始化相关硬件接口
+    if(fun_callback != NULL)
+        fun_callback();
+    
+    return error;
+}
+
+
+
+/*
+    （3）实现提供给用户调用的应用层接口
+*/
+
+/*
+    检查参数并以任意传输接口绑定设备，由InitTransport和GroupInitTransport共用
+*/
+static DAC80501_Error Dac80501_BindTransport(dac80501_t* dev, const DAC80501_Transport* transport, DAC80501_Volt vout_default)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //若传输接口无效, 直接返回
+    CHECK_PTR(transport, error, spi);
+    CHECK_PTR(transport->Write, error, spi);
+    
+#if DAC80501_USE_STM32_HAL
+    //不使用HAL库的SPI和SYNC#信号
+    dev->sync_GPIO  = NULL;
+    dev->sync_BIT   = 0;
+    dev->hspi       = NULL;
+#endif
+    
+    return Dac80501_Bind(dev, transport, vout_default);
+}
+
+ /*
+    以任意传输接口初始化DAC80501，传输接口的内容会被复制到设备描述符中
+    注意该函数并不负责初始化传输接口所使用的硬件
+*/
+static DAC80501_Error DAC80501_InitTransport(dac80501_t* dev, const DAC80501_Transport* transport, 
+	DAC80501_Volt vout_default, void (*fun_callback)(void))
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    error = Dac80501_BindTransport(dev, transport, vout_default);
+    if(error.data)
+        return error;
+    
+    //快照有效时热启动，否则重置芯片
+    return Dac80501_GroupStart(&dev, 1, fun_callback);
+}
+
+#if DAC80501_USE_STM32_HAL
+
+/*
+    检查参数并以HAL库的SPI和SYNC#信号绑定设备，由Init和GroupInit共用
+*/
+static DAC80501_Error Dac80501_BindHal(dac80501_t* dev, SPI_HandleTypeDef *hspi, GPIO_TypeDef* sync_GPIO, const uint16_t sync_BIT, 
+	DAC80501_Volt vout_default)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //若设备没有绑定SPI接口, 直接返回
+    CHECK_PTR(hspi, error, spi);
+    
+    //如果SYNC#信号线无效，直接返回
+    CHECK_PTR(sync_GPIO, error, sync);
+    
+    //绑定SYNC#信号
+    dev->sync_GPIO  = sync_GPIO;
+    dev->sync_BIT   = sync_BIT;
+    
+    //绑定SPI接口
+    dev->hspi = hspi;
+    
+    //以HAL库作为传输接口
+    DAC80501_Transport transport = {dev, Dac80501_HAL_Write};
+    
+    return Dac80501_Bind(dev, &transport, vout_default);
+}
+
+/*
+    初始化DAC80501, 
+    注意该函数绑定spi接口，但并不负责初始化对应的SPI接口
+*/
+static DAC80501_Error  DAC80501_Init(dac80501_t* dev, SPI_HandleTypeDef *hspi, GPIO_TypeDef* sync_GPIO, const uint16_t sync_BIT, 
+	DAC80501_Volt vout_default, void (*fun_callback)(void))
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    error = Dac80501_BindHal(dev, hspi, sync_GPIO, sync_BIT, vout_default);
+    if(error.data)
+        return error;
+    
+    //快照有效时热启动，否则重置芯片
+    return Dac80501_GroupStart(&dev, 1, fun_callback);
+}
+
+#endif
+
+ /*
+    反初始化DAC80501, 
+    注意该函数绑定spi接口，但并不负责初始化对应的SPI接口
+*/
+static DAC80501_Error DAC80501_DeInit(dac80501_t* dev, void (*fun_callback)(void))
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //重置芯片
+    error = dev->SoftReset(dev);
+	
+#if DAC80501_USE_STM32_HAL
+    //先将SYNC信号失效
+    if(dev->sync_GPIO != NULL)
+        DISABLE_SYNC(dev);
+#endif
+    
+    //释放空间并解绑SPI接口、SYNC#信号和传输接口
+    Dac80501_Unbind(dev);
+    
+    //调用回调函数，用户可在回调函数中反初始化相关硬件接口
+    if(fun_callback != NULL)
+        fun_callback();
+    
+    return error;
+}
+
+  /*
+        设置外部基准电压，注意调用该函数会自动禁用内部基准源
+    */
+static DAC80501_Error DAC80501_SetRefVolt(dac80501_t* dev, const DAC80501_Volt ref_volt)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //若基准电压小于0，直接返回
+    if(ref_volt<0)
+    {
+        error.ref_volt = 1;
+		DAC80501_PRINT_DEBUG("The ref_volt(%lfV) is smaller than 0V.\n", DAC80501_PRINT_VOLT(ref_volt));
+        return error;
+    }
+	
+	//若基准电压大于DAC的最大供电电压，直接返回
+	if(ref_volt > DAC80501_VOUT_LIMIT)
+	{
+		error.ref_volt = 1;
+		DAC80501_PRINT_DEBUG("The ref_volt(%lfV) is bigger than %lfV.\n", DAC80501_PRINT_VOLT(ref_volt), DAC80501_MAX_VOUT);
+        return error;
+	}
+	
+	//基准电压就是当前设置，直接返回
+	if(ref_volt == dev->option->ref_volt[1])
+		return error;
+	
+	//更改基准电压前，先确定当前实际输出的电压
+	Dac80501_SyncVoutSet(dev);
+    
+	//使用外部基准源
+	error = dev->SetRefPower(dev, 1);
+	
+	if(!error.data)
+	{
+		Dac80501_SetLadder(dev, ref_volt);
+		
+		//更改外部基准电压后，再同步DAC寄存器的值
+		dev->SetDacOut(dev, dev->option->vout_set);
+	}
+	else
+		DAC80501_PRINT_DEBUG("Set ref_volt failed, error code is %d.\n", error.data);
+
+    return error;
+}
+
+
+#if DAC80501_ENABLE_REG_API
+
+/*
+    设置 SYNC 寄存器的 DAC_SYNC_EN 字段
+    enable:只有最低位有效；最低位为1时，DAC输出设置为响应LDAC触发而更新（同步模式）。
+    当为0时，DAC输出设置为立即更新（异步模式）。
+*/
+static DAC80501_Error DAC80501_SetDacSync(dac80501_t* dev, const uint8_t enable)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //写入数据
+    dev->sync->dac_sync_en = enable & 0x1;
+    error.data |= Dac80501_SPI_Write(dev, SYNC, dev->sync->data).data;
+    
+    return error;
+}
+
+#endif
+
+/*
+    设置内部基准电压源
+    disable:只有最低位有效；最低位为0时使能内部基准源。
+*/
+static DAC80501_Error DAC80501_SetRefPower(dac80501_t* dev, const uint8_t disable)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //写入数据
+    dev->config->ref_pwdwn = disable & 0x1;
+    error.data |= Dac80501_SPI_Write(dev, CONFIG, dev->config->data).data;
+    
+    //如果启用内部基准电压源，则同步修改基准电压设置
+    if((error.data == 0) && (disable == 0))
+        Dac80501_SetLadder(dev, DAC80501_VREF_INTERNAL);
+    
+    return error;
+}
+
+#if DAC80501_ENABLE_REG_API
+
+ /*
+    设置DAC输出
+    disable:只有最低位有效；最低位为1时，DAC处于关断模式，DAC输出通过1 kΩ内部电阻连接至GND。
+*/
+static DAC80501_Error DAC80501_SetDacPower(dac80501_t* dev, const uint8_t disable)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //写入数据
+    dev->config->dac_pwdwn = disable & 0x1;
+    error.data |= Dac80501_SPI_Write(dev, CONFIG, dev->config->data).data;
+    
+    return error;
+}
+
+/*
+    设置DAC基准电压分压系数
+    div: 只能为1或2；可以将器件的基准电压（来自内部或外部基准电压源）除以div
+*/
+static DAC80501_Error Dac80501_SetRefDiv(dac80501_t* dev, const uint8_t div)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //若div非法，直接返回
+    if((div != 1) && (div != 2))
+    {
+        error.div = 1;
+		DAC80501_PRINT_DEBUG("The div is only set to 1 or 2，but this is %d\n", div);
+        return error;
+    }
+    
+    //写入数据
+    dev->gain->ref_div = div - 1;
+    error.data |= Dac80501_SPI_Write(dev, GAIN, dev->gain->data).data;
+    
+    return error;
+}
+
+ /*
+    设置DAC内部缓冲放大器增益
+    gain: 只能为1或2；为1时实际增益为1（即无输出增益），为2时实际增益为2。
+*/
+static DAC80501_Error Dac80501_SetBuffGain(dac80501_t* dev, const uint8_t gain)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //若gain非法，直接返回
+    if((gain != 1) && (gain != 2))
+    {
+        error.gain = 1;
+		DAC80501_PRINT_DEBUG("The gain is only set to 1 or 2，but this is %d\n", gain);
+        return error;
+    }
+    
+    //写入数据
+    dev->gain->buff_gain = gain - 1;
+    error.data |= Dac80501_SPI_Write(dev, GAIN, dev->gain->data).data;
+    
+    return error;
+}
+
+#endif
+
+ /*
+    软重置DAC80501芯片，DAC将恢复为默认上电状态
+*/
+static DAC80501_Error Dac80501_SoftReset(dac80501_t* dev)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //若芯片此时正在复位，保险起见先延时
+    Dac80501_ResetDelay();
+    
+    error = Dac80501_ResetSend(dev);
+    
+    //等待复位完成
+    Dac80501_ResetDelay();
+	
+	//恢复设置的输出电压
+	error.data |= Dac80501_ResetRestore(dev).data;
+    
+    return error;
+}
+
+/*
+    设置DAC输出值
+    dac_data: 该值将直接送入DAC数据寄存器。数据以直接二进制格式进行MSB对齐
+*/
+static DAC80501_Error Dac80501_SetDacOut(dac80501_t* dev, const DAC80501_Volt vout)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //检查期望输出电压
+    error = Dac80501_CheckVout(dev, vout);
+    if(error.data)
+        return error;
+    
+    //更新设置输出电压
+    dev->option->vout_set = vout;
+    dev->option->vout_dirty = 0;
+    
+    //依据期望输出电压选择量程并换算为DAC数据
+    uint8_t range;
+    uint16_t code;
+    
+    Dac80501_Encode(dev, vout, &range, &code);
+    
+    //如果按照当前配置，需要输出的电压不在当前量程，则按量程变化的方向依次更改增益配置和写入数据
+    error = Dac80501_WriteRangeCode(dev, range, code);
+    
+    DAC80501_PRINT_DEBUG("DAC Setting: DIV:%d, GAIN:%d, VOUT_MAX:%lfV, VOUT:%lfV\n", 
+    dev->gain->ref_div, dev->gain->buff_gain, DAC80501_PRINT_VOLT(dev->option->ref_volt[range]), DAC80501_PRINT_VOLT(vout));
+    
+    return error;
+}    
+
+#if DAC80501_ENABLE_REG_API
+
+ /*
+        设置LDAC模式
+        enable：只有最低位有效；最低位为1时，以同步模式同步加载DAC设定值
+    */
+static DAC80501_Error DAC80501_SetLDAC(dac80501_t* dev, const uint8_t enable)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //写入数据
+    dev->trigger->ldac = enable & 0x1;
+    error.data |= Dac80501_SPI_Write(dev, TRIGGER, dev->trigger->data).data;
+    
+    return error;
+}
+
+#endif
+
+/*
+    设置DAC输出量程
+    range: 取值见DAC80501_Range；仅当量程与当前量程不同时才写入GAIN寄存器
+    只写GAIN寄存器，输出电压随满量程成比例变化，切换量程同时改变输出应使用SetDacRangeCode
+*/
+static DAC80501_Error Dac80501_SetDacRange(dac80501_t* dev, const uint8_t range)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //若量程非法，直接返回，以param区分参数错误与GAIN寄存器写入失败
+    if(range > DAC80501_RANGE_DOUBLE)
+    {
+        error.param = 1;
+		DAC80501_PRINT_DEBUG("The range is only set to 0, 1 or 2, but this is %d\n", range);
+        return error;
+    }
+    
+    error = Dac80501_WriteRange(dev, range);
+    
+    //量程改变后实际输出电压随之改变，期望输出电压留待需要时依据新的量程再计算
+    if(!error.data)
+        dev->option->vout_dirty = 1;
+    
+    return error;
+}
 
+/*
+    同时设置DAC输出量程和DAC数据寄存器，按量程变化的方向排序数据帧，避免中间输出超调
+    range: 取值见DAC80501_Range
+    code: 该量程下的16位DAC数据
+*/
+static DAC80501_Error Dac80501_SetDacRangeCode(dac80501_t* dev, const uint8_t range, const uint16_t code)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    //若量程非法，直接返回
+    if(range > DAC80501_RANGE_DOUBLE)
+    {
+        error.param = 1;
+		DAC80501_PRINT_DEBUG("The range is only set to 0, 1 or 2, but this is %d\n", range);
+        return error;
+    }
+    
+    dev->option->vout_dirty = 1;
+    
+    return Dac80501_WriteRangeCode(dev, range, code);
+}
 
- /*
-    软重置DAC80501芯片，DAC将恢复为默认上电状态
+/*
+    在当前量程下直接设置DAC数据寄存器
+    code: 16位DAC数据，不做电压换算，适合在定时器或DMA中断中高速刷新输出
 */
-static DAC80501_Error Dac80501_SoftReset(dac80501_t* dev)
+static DAC80501_Error Dac80501_SetDacCode(dac80501_t* dev, const uint16_t code)
 {
     DAC80501_Error error;
     error.data = 0;
@@ -490,147 +1300,202 @@ static DAC80501_Error Dac80501_SoftReset(dac80501_t* dev)
     //若设备不存在，直接返回
     CHECK_PTR(dev, error, dev);
     
-    //若芯片此时正在复位，保险起见先延时
-    //复位以后需要至少延时1ms等待期间复位完成，这里延时1ms
-    for(uint32_t i=0; i<1000; i++)
-        DAC80501_DELAY_1US;
+    //写入数据，此处不做浮点运算，期望输出电压留待需要时再计算
+    dev->dac->dac_data = code;
+    dev->option->vout_dirty = 1;
+    error.data |= Dac80501_SPI_Write(dev, DAC, dev->dac->dac_data).data;
     
-    //写入数据
-    dev->trigger->soft_reset = TRIGGER_SOFT_RESET;
-    error = Dac80501_SPI_Write(dev, TRIGGER, dev->trigger->data);
+    return error;
+}
+
+/*
+    获取当前DAC输出量程
+    range: 用于保存量程的指针，取值见DAC80501_Range
+*/
+static DAC80501_Error Dac80501_GetDacRange(dac80501_t* dev, uint8_t* range)
+{
+    DAC80501_Error error;
+    error.data = 0;
     
-    //同步更新寄存器的值
-    if(!error.data)
-    {
-        //设置参考电压为内部基准电压
-		dev->option->ref_volt[0] = DAC80501_INTERNAL_VREF / 2.0;
-		dev->option->ref_volt[1] = DAC80501_INTERNAL_VREF;
-		dev->option->ref_volt[2] = DAC80501_INTERNAL_VREF * 2.0;
-        
-        //重置寄存器参数
-        dev->sync->data = 0;
-        dev->config->data = 0;
-        dev->gain->data = 1;
-        dev->trigger->data = 0;
-        dev->dac->data = 0; //由于SPI模式无法读取芯片型号，这里暂时默认为0
-    }
+    //若设备或输出指针不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    CHECK_PTR(range, error, dev);
     
-    //复位以后需要至少延时1ms等待期间复位完成，这里延时1ms
-    for(uint32_t i=0; i<1000; i++)
-        DAC80501_DELAY_1US;
-	
-	//同步更新DAC寄存器的值，保证复位后实际输出电压为设置的输出电压
-	error = dev->SetDacOut(dev, dev->option->vout_set);
+    *range = DAC80501_CUR_RANGE(dev);
     
     return error;
 }
 
 /*
-    设置DAC输出值
-    dac_data: 该值将直接送入DAC数据寄存器。数据以直接二进制格式进行MSB对齐
+    获取当前基准电压
+    ref_volt: 用于保存基准电压的指针，三个量程的满量程分别为其一半、一倍和两倍
 */
-static DAC80501_Error Dac80501_SetDacOut(dac80501_t* dev, const double vout)
+static DAC80501_Error Dac80501_GetRefVolt(dac80501_t* dev, DAC80501_Volt* ref_volt)
 {
     DAC80501_Error error;
     error.data = 0;
     
-    //若设备不存在，直接返回
+    //若设备或输出指针不存在，直接返回
     CHECK_PTR(dev, error, dev);
+    CHECK_PTR(ref_volt, error, dev);
     
-    //若基准电压值小于0V，直接返回
-    if(dev->option->ref_volt[1] < 0)
-    {
-        error.ref_volt = 1;
-		DAC80501_PRINT_DEBUG("The ref_volt(%lfV) is smaller than 0V.\n", vout);
+    *ref_volt = dev->option->ref_volt[1];
+    
+    return error;
+}
+
+#if DAC80501_ENABLE_PREPARED
+
+/*
+    预编码DAC输出值，句柄中保存当前基准电压下的GAIN和DAC数据帧
+*/
+static DAC80501_Error Dac80501_PrepareDacOut(dac80501_t* dev, DAC80501_Prepared* prepared, const DAC80501_Volt vout)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备或句柄不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    CHECK_PTR(prepared, error, param);
+    
+    //检查期望输出电压
+    error = Dac80501_CheckVout(dev, vout);
+    if(error.data)
         return error;
-    }
     
-    //若设置的DAC输出电压大于芯片所能输出最大的输出电压
-    //或者依据当前基准电压，需要输出的电压大于实际可输出的最大电压，则返回
-    if((vout > DAC80501_MAX_VOUT) || (vout > dev->option->ref_volt[2]))
+    uint8_t range;
+    uint16_t code;
+    
+    Dac80501_Encode(dev, vout, &range, &code);
+    
+    uint16_t gain = Dac80501_RangeGain(dev, range);
+    
+    //编码GAIN、DAC、GAIN数据帧，量程变小时发送前两帧，变大时发送后两帧
+    prepared->frames[0] = GAIN;
+    prepared->frames[1] = (gain >> 8) & 0xFF;
+    prepared->frames[2] = gain & 0xFF;
+    prepared->frames[3] = DAC;
+    prepared->frames[4] = (code >> 8) & 0xFF;
+    prepared->frames[5] = code & 0xFF;
+    memcpy(&prepared->frames[6], prepared->frames, 3);
+    
+    prepared->dev       = dev;
+    prepared->range     = range;
+    prepared->ref_gen   = dev->option->ref_gen;
+    prepared->vout      = vout;
+    
+    return error;
+}
+
+/*
+    以预编码的句柄设置DAC输出值
+*/
+static DAC80501_Error Dac80501_ApplyPrepared(dac80501_t* dev, DAC80501_Prepared* prepared)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备或句柄不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    CHECK_PTR(prepared, error, param);
+    
+    //句柄不属于该设备，直接返回，不发送数据
+    if(prepared->dev != dev)
     {
-        error.out_volt = 1;
-		DAC80501_PRINT_DEBUG("The expected voltage(%lfV) is bigger than %lfV or %lfV\n", 
-		vout, DAC80501_MAX_VOUT, dev->option->ref_volt[2]);
+        error.param = 1;
+        DAC80501_PRINT_DEBUG("The prepared handle belongs to another device.\n");
         return error;
-		
     }
     
-	//更新设置输出电压
-	dev->option->vout_set = vout;
-	
-    //如果按照当前配置，需要输出的电压大于实际可输出电压，则更改增益配置
-    double vout_max =  dev->option->ref_volt[(!dev->gain->ref_div) + dev->gain->buff_gain];
-	
-    //如果输出电压大于基准电压，则增益为2
-    if(vout > dev->option->ref_volt[1])
+    //预编码后基准电压已改变，则重新编码
+    if(prepared->ref_gen != dev->option->ref_gen)
     {
-        //将分压比设置为1，增益设置为2
-        if(vout_max != dev->option->ref_volt[2])
-        {
-            dev->gain->buff_gain = 1;
-            dev->gain->ref_div   = 0;
-            error = Dac80501_SPI_Write(dev, GAIN, dev->gain->data);
-        
-            if(error.data)
-                return error;
-        
-            vout_max = dev->option->ref_volt[2];
-        }
+        error = Dac80501_PrepareDacOut(dev, prepared, prepared->vout);
+        if(error.data)
+            return error;
     }
     
-    //如果输出电压大于基准电压的一半，则不分压也不增益
-    else if(vout > dev->option->ref_volt[0])
-    {
-        //将分压比设置为1，增益设置为1
-        if(vout_max != dev->option->ref_volt[1])
-        {
-            dev->gain->buff_gain = 0;
-            dev->gain->ref_div   = 0;
-            error = Dac80501_SPI_Write(dev, GAIN, dev->gain->data);
-        
-            if(error.data)
-                return error;
-        
-            vout_max = dev->option->ref_volt[1];
-        }
-    }
+    uint8_t cur = DAC80501_CUR_RANGE(dev);
+    uint16_t code = (prepared->frames[4] << 8) | prepared->frames[5];
     
-    //如果输出电压不大于基准电压的一半，自动分压
-    else if(vout_max != dev->option->ref_volt[0])
+    dev->option->vout_set = prepared->vout;
+    dev->option->vout_dirty = 0;
+    
+    //同步模式下量程改变时需要插入LDAC触发
+    if((cur != prepared->range) && dev->sync->dac_sync_en)
+        return Dac80501_WriteRangeCode(dev, prepared->range, code);
+    
+    //量程未改变时只发送DAC数据帧，量程变小时先发送GAIN数据帧，变大时后发送GAIN数据帧
+    uint16_t count = 1;
+    const uint8_t* frames = &prepared->frames[3];
+    
+    if(cur != prepared->range)
     {
-        //将分压比设置为2，增益设置为1
-        dev->gain->buff_gain = 0;
-        dev->gain->ref_div   = 1;
-        error = Dac80501_SPI_Write(dev, GAIN, dev->gain->data);
-        
-        if(error.data)
-            return error;
-        
-        vout_max = dev->option->ref_volt[0];
+        dev->gain->data = (prepared->frames[1] << 8) | prepared->frames[2];
+        frames = (prepared->range < cur) ? prepared->frames : &prepared->frames[3];
+        count = 2;
     }
-        
     
-    //将电压值转换为16位DAC数据
-    if(vout == vout_max)
-        dev->dac->dac_data = DAC80501_MAX_DAC_DATA - 1;
-    else
-        dev->dac->dac_data = round((vout * DAC80501_MAX_DAC_DATA) / vout_max);
+    //同步更新寄存器的值
+    dev->dac->dac_data = code;
     
-    //写入数据
-    error.data |= Dac80501_SPI_Write(dev, DAC, dev->dac->dac_data).data;
+    return Dac80501_SPI_WriteFrames(dev, frames, count);
+}
+
+#endif
+
+#if DAC80501_ENABLE_SNAPSHOT
+
+/*
+    设置热启动快照，下一次Init或InitTransport时由快照恢复而不重置芯片
+*/
+static DAC80501_Error Dac80501_SetWarmStart(dac80501_t* dev, const DAC80501_Snapshot* snapshot)
+{
+    DAC80501_Error error;
+    error.data = 0;
     
-    DAC80501_PRINT_DEBUG("DAC Setting: DIV:%d, GAIN:%d, VOUT_MAX:%lfV, VOUT:%lfV\n", 
-    dev->gain->ref_div, dev->gain->buff_gain, vout_max, vout);
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    dev->warm_snapshot = snapshot;
     
     return error;
-}    
+}
 
- /*
-        设置LDAC模式
-        enable：只有最低位有效；最低位为1时，以同步模式同步加载DAC设定值
-    */
-static DAC80501_Error DAC80501_SetLDAC(dac80501_t* dev, const uint8_t enable)
+/*
+    保存当前寄存器与配置到快照
+*/
+static DAC80501_Error Dac80501_SaveSnapshot(dac80501_t* dev, DAC80501_Snapshot* snapshot)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备或快照不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    CHECK_PTR(snapshot, error, param);
+    
+    //若DAC数据寄存器被直接写入，先计算实际输出的电压
+    Dac80501_SyncVoutSet(dev);
+    
+    snapshot->ref_volt  = dev->option->ref_volt[1];
+    snapshot->vout_set  = dev->option->vout_set;
+    snapshot->magic     = DAC80501_SNAPSHOT_MAGIC;
+    snapshot->sync      = dev->sync->data;
+    snapshot->config    = dev->config->data;
+    snapshot->gain      = dev->gain->data;
+    snapshot->trigger   = dev->trigger->data;
+    snapshot->dac       = dev->dac->data;
+    snapshot->crc       = Dac80501_SnapshotCrc(snapshot);
+    
+    return error;
+}
+
+#endif
+
+/*
+    开始批量发送，此后写入的数据帧先缓存，直到EndBatch时一次提交给传输接口
+*/
+static DAC80501_Error Dac80501_BeginBatch(dac80501_t* dev)
 {
     DAC80501_Error error;
     error.data = 0;
@@ -638,13 +1503,25 @@ static DAC80501_Error DAC80501_SetLDAC(dac80501_t* dev, const uint8_t enable)
     //若设备不存在，直接返回
     CHECK_PTR(dev, error, dev);
     
-    //写入数据
-    dev->trigger->ldac = enable & 0x1;
-    error.data |= Dac80501_SPI_Write(dev, TRIGGER, dev->trigger->data).data;
+    Dac80501_BatchBegin(dev);
     
     return error;
 }
 
+/*
+    结束批量发送，最外层调用时提交所有缓存的数据帧
+*/
+static DAC80501_Error Dac80501_EndBatch(dac80501_t* dev)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(dev, error, dev);
+    
+    return Dac80501_BatchEnd(dev);
+}
+
 /*
     (4)给出初始化DAC80501驱动的函数接口
 */
@@ -657,19 +1534,167 @@ DAC80501_Error DAC80501_SPI_API_INIT(dac80501_t* dev)
     //若设备不存在，直接返回
     CHECK_PTR(dev, error, dev);
     
+#if DAC80501_ENABLE_SNAPSHOT
+    //默认冷启动
+    dev->warm_snapshot = NULL;
+#endif
+    
     //绑定函数接口
+#if DAC80501_USE_STM32_HAL
     dev->Init           = DAC80501_Init;
+#endif
+    dev->InitTransport  = DAC80501_InitTransport;
     dev->DeInit         = DAC80501_DeInit;
     dev->SetRefVolt     = DAC80501_SetRefVolt;
-    dev->SetBuffGain    = Dac80501_SetBuffGain;
     dev->SetDacOut      = Dac80501_SetDacOut;
-    dev->SetDacPower    = DAC80501_SetDacPower;
     dev->SetRefPower    = DAC80501_SetRefPower;
-    dev->SetDacSync     = DAC80501_SetDacSync;
     dev->SoftReset      = Dac80501_SoftReset;
+#if DAC80501_ENABLE_REG_API
+    dev->SetBuffGain    = Dac80501_SetBuffGain;
+    dev->SetDacPower    = DAC80501_SetDacPower;
+    dev->SetDacSync     = DAC80501_SetDacSync;
     dev->SetRefDiv      = Dac80501_SetRefDiv;
     dev->SetLDAC        = DAC80501_SetLDAC;
+#endif
+    dev->SetDacRange    = Dac80501_SetDacRange;
+    dev->SetDacCode     = Dac80501_SetDacCode;
+    dev->SetDacRangeCode= Dac80501_SetDacRangeCode;
+    dev->GetDacRange    = Dac80501_GetDacRange;
+    dev->GetRefVolt     = Dac80501_GetRefVolt;
+#if DAC80501_ENABLE_PREPARED
+    dev->PrepareDacOut  = Dac80501_PrepareDacOut;
+    dev->ApplyPrepared  = Dac80501_ApplyPrepared;
+#endif
+#if DAC80501_ENABLE_SNAPSHOT
+    dev->SetWarmStart   = Dac80501_SetWarmStart;
+    dev->SaveSnapshot   = Dac80501_SaveSnapshot;
+#endif
+    dev->BeginBatch     = Dac80501_BeginBatch;
+    dev->EndBatch       = Dac80501_EndBatch;
+    
+    return error;
+}
+
+/*
+    (5)给出同时操作多个DAC80501的函数接口
+*/
+
+/*
+    同时软重置多个已初始化的DAC80501
+    所有设备的复位命令连续发送，只等待一次复位完成时间，再依次恢复各设备的输出电压
+*/
+DAC80501_Error DAC80501_GroupSoftReset(dac80501_t* const* devs, const uint16_t count)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备不存在，直接返回
+    CHECK_PTR(devs, error, dev);
+    
+    for(uint16_t i=0; i<count; i++)
+        CHECK_PTR(devs[i], error, dev);
+    
+    //若芯片此时正在复位，保险起见先延时
+    Dac80501_ResetDelay();
+    
+    for(uint16_t i=0; i<count; i++)
+        error.data |= Dac80501_ResetSend(devs[i]).data;
+    
+    //所有设备共用一次复位完成时间
+    Dac80501_ResetDelay();
+    
+    //依次恢复各设备设置的输出电压，每个设备只调用一次传输接口
+    for(uint16_t i=0; i<count; i++)
+        error.data |= Dac80501_ResetRestore(devs[i]).data;
     
     return error;
 }
 
+/*
+    以任意传输接口同时初始化多个DAC80501
+*/
+DAC80501_Error DAC80501_GroupInitTransport(dac80501_t* const* devs, const DAC80501_Transport* transports, 
+	const DAC80501_Volt* vout_default, const uint16_t count, void (*fun_callback)(void))
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备、传输接口或默认输出电压不存在，直接返回
+    CHECK_PTR(devs, error, dev);
+    CHECK_PTR(transports, error, spi);
+    CHECK_PTR(vout_default, error, param);
+    
+    //先检查所有设备的参数，任一设备参数有误时不分配空间也不发送数据
+    for(uint16_t i=0; i<count; i++)
+    {
+        CHECK_PTR(devs[i], error, dev);
+        CHECK_PTR(transports[i].Write, error, spi);
+        
+        error = Dac80501_CheckDefault(vout_default[i]);
+        if(error.data)
+            return error;
+    }
+    
+    //存储空间不足导致某个设备绑定失败时，释放之前已绑定的设备
+    for(uint16_t i=0; i<count; i++)
+    {
+        error = Dac80501_BindTransport(devs[i], &transports[i], vout_default[i]);
+        if(error.data)
+        {
+            for(uint16_t j=0; j<i; j++)
+                Dac80501_Unbind(devs[j]);
+            
+            return error;
+        }
+    }
+    
+    return Dac80501_GroupStart(devs, count, fun_callback);
+}
+
+#if DAC80501_USE_STM32_HAL
+
+/*
+    以HAL库的SPI和SYNC#信号同时初始化多个DAC80501
+*/
+DAC80501_Error DAC80501_GroupInit(dac80501_t* const* devs, SPI_HandleTypeDef* const* hspi, GPIO_TypeDef* const* sync_GPIO, 
+	const uint16_t* sync_BIT, const DAC80501_Volt* vout_default, const uint16_t count, void (*fun_callback)(void))
+{
+    DAC80501_Error error;
+    error.data = 0;
+    
+    //若设备、SPI接口、SYNC#信号或默认输出电压不存在，直接返回
+    CHECK_PTR(devs, error, dev);
+    CHECK_PTR(hspi, error, spi);
+    CHECK_PTR(sync_GPIO, error, sync);
+    CHECK_PTR(sync_BIT, error, sync);
+    CHECK_PTR(vout_default, error, param);
+    
+    //先检查所有设备的参数，任一设备参数有误时不分配空间也不发送数据
+    for(uint16_t i=0; i<count; i++)
+    {
+        CHECK_PTR(devs[i], error, dev);
+        CHECK_PTR(hspi[i], error, spi);
+        CHECK_PTR(sync_GPIO[i], error, sync);
+        
+        error = Dac80501_CheckDefault(vout_default[i]);
+        if(error.data)
+            return error;
+    }
+    
+    //存储空间不足导致某个设备绑定失败时，释放之前已绑定的设备
+    for(uint16_t i=0; i<count; i++)
+    {
+        error = Dac80501_BindHal(devs[i], hspi[i], sync_GPIO[i], sync_BIT[i], vout_default[i]);
+        if(error.data)
+        {
+            for(uint16_t j=0; j<i; j++)
+                Dac80501_Unbind(devs[j]);
+            
+            return error;
+        }
+    }
+    
+    return Dac80501_GroupStart(devs, count, fun_callback);
+}
+
+#endif
@@ -5,6 +5,92 @@
 
 @brief		基于三线制SPI的DAC80501驱动头文件，需要支持HAL库
 
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    2.7
+
+(1)增加了同时操作多个DAC80501的接口（DAC80501_GroupSoftReset/DAC80501_GroupInitTransport/DAC80501_GroupInit），
+   所有设备的复位命令连续发送并共用一次复位完成时间，初始化N个设备的耗时不再随N线性增加；
+(2)SoftReset发送复位命令失败时，即使恢复输出电压成功也返回spi错误
+
+--------------------------------------------------------
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    2.6
+
+(1)增加了功能裁剪配置（DAC80501_PROFILE），可在dac80501_spi_conf.h中选择完整、精简或最小配置，
+   并可单独开关寄存器级接口、预编码、热启动以及各扩展模块；
+(2)电压参数统一为DAC80501_Volt类型，可由DAC80501_MATH选择双精度、单精度或以uV为单位的定点运算；
+(3)DAC80501_USE_MALLOC为0时，寄存器与配置结构体由静态存储池分配，最多DAC80501_MAX_DEVICES个设备；
+(4)修复了DAC80501_PRINT_DEBUG_INFO以#ifdef判断，定义为0时仍然打印调试信息的BUG；
+(5)期望输出电压小于0V时返回out_volt错误；
+(6)初始化时寄存器初值清零，修复了动态申请的TRIGGER寄存器为随机值时，软重置会同时写入随机LDAC字段的BUG
+
+--------------------------------------------------------
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    2.5
+
+(1)SetDacOut等需要同时更改量程和DAC数据的接口按量程变化的方向排序数据帧：量程变大时先写DAC数据，
+   变小时先写GAIN，使切换量程时唯一的中间输出不超过起止电压中的较大值，且尽可能位于起止电压之间；
+(2)同步模式（DAC_SYNC_EN为1）下切换量程时自动插入LDAC触发，避免新的量程与旧的DAC数据长时间共存；
+(3)增加了SetDacRangeCode接口，供插值等模块在切换量程时使用
+
+--------------------------------------------------------
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    2.4
+
+(1)增加了热启动接口（SetWarmStart/SaveSnapshot），MCU复位而DAC80501保持供电时，
+   可由保存在掉电保持RAM或备份寄存器中的快照恢复驱动状态，不再软重置芯片，
+   只发送与期望输出不同的GAIN和DAC数据帧；快照校验失败时自动退回软重置
+
+--------------------------------------------------------
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    2.3
+
+(1)增加了预编码接口（PrepareDacOut/ApplyPrepared），在固定的几个电压之间切换时，
+   只需发送预先编码好的数据帧，不再重复校验、选择量程和换算；
+(2)SetRefVolt/SetRefPower/SoftReset更改基准电压后，已预编码的句柄在下一次使用时自动重新编码；
+(3)电压换算结果四舍五入后超出16位时取最大DAC数据，不再回绕为0
+
+--------------------------------------------------------
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    2.2
+
+(1)将底层通信抽象为传输接口（DAC80501_Transport），STM32 HAL库只是其中一种实现，
+   可通过dac80501_spi_conf.h中的DAC80501_USE_STM32_HAL宏关闭，以便在Linux等平台上使用；
+(2)增加了InitTransport接口，以任意传输接口初始化DAC80501；
+(3)增加了批量发送接口（BeginBatch/EndBatch），多帧数据可由传输接口一次提交，
+   SetDacOut同时更改量程和DAC数据时也合并为一次提交
+
+--------------------------------------------------------
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    2.1
+
+(1)增加了按量程直接写入DAC数据的接口（SetDacRange/SetDacCode），供插值等需要在中断中高速刷新输出的模块使用；
+(2)增加了查询当前量程和基准电压的接口（GetDacRange/GetRefVolt）；
+(3)直接写入DAC数据后，软重置或更改基准电压时仍能恢复为最后一次实际输出的电压；
+(4)错误类型扩展为16位，增加了参数错误和缓冲区已满两种错误
+
+--------------------------------------------------------
 @time		2024/08/30
 
 @author		丁鹏龙
@@ -43,7 +129,56 @@ extern "C" {
 
 //引入系统头文件
 #include <stdint.h>
+#include "dac80501_spi_conf.h"
+
+//兼容未定义传输接口选择的旧版配置文件
+#ifndef DAC80501_USE_STM32_HAL
+#define DAC80501_USE_STM32_HAL 1
+#endif
+
+#if DAC80501_USE_STM32_HAL
 #include "stm32f1xx_hal.h"
+#endif
+
+//功能裁剪配置，在dac80501_spi_conf.h中以DAC80501_PROFILE选择，未单独定义的功能开关按所选配置取默认值
+#define DAC80501_PROFILE_FULL       0   //全部功能，双精度浮点运算，动态申请空间
+#define DAC80501_PROFILE_SMALL      1   //单精度浮点运算，静态分配空间，裁剪寄存器级接口、预编码、热启动和扩展模块
+#define DAC80501_PROFILE_MINIMAL    2   //定点运算，其余同DAC80501_PROFILE_SMALL
+
+//电压运算方式，由DAC80501_MATH选择
+#define DAC80501_MATH_DOUBLE        0   //双精度浮点数，单位V
+#define DAC80501_MATH_FLOAT         1   //单精度浮点数，单位V，适合带单精度FPU的MCU
+#define DAC80501_MATH_FIXED         2   //32位整数，单位uV，不使用任何浮点运算
+
+//兼容未定义功能裁剪配置的旧版配置文件
+#ifndef DAC80501_PROFILE
+#define DAC80501_PROFILE DAC80501_PROFILE_FULL
+#endif
+
+#ifndef DAC80501_MATH
+#if DAC80501_PROFILE == DAC80501_PROFILE_FULL
+#define DAC80501_MATH DAC80501_MATH_DOUBLE
+#elif DAC80501_PROFILE == DAC80501_PROFILE_SMALL
+#define DAC80501_MATH DAC80501_MATH_FLOAT
+#else
+#define DAC80501_MATH DAC80501_MATH_FIXED
+#endif
+#endif
+
+//寄存器级设置接口：SetDacSync、SetDacPower、SetRefDiv、SetBuffGain、SetLDAC
+#ifndef DAC80501_ENABLE_REG_API
+#define DAC80501_ENABLE_REG_API (DAC80501_PROFILE == DAC80501_PROFILE_FULL)
+#endif
+
+//预编码接口：PrepareDacOut、ApplyPrepared
+#ifndef DAC80501_ENABLE_PREPARED
+#define DAC80501_ENABLE_PREPARED (DAC80501_PROFILE == DAC80501_PROFILE_FULL)
+#endif
+
+//热启动接口：SetWarmStart、SaveSnapshot
+#ifndef DAC80501_ENABLE_SNAPSHOT
+#define DAC80501_ENABLE_SNAPSHOT (DAC80501_PROFILE == DAC80501_PROFILE_FULL)
+#endif
 
 
 /*
@@ -56,6 +191,29 @@ extern "C" {
 //定义DAC80501的最大输出电压为5.5V
 #define DAC80501_MAX_VOUT 5.5
 
+/*
+    定义电压类型，所有以电压为参数的接口均使用该类型
+    DAC80501_MATH_FIXED时单位为uV，其余为V；常量电压应以DAC80501_VOLT(x)给出，x的单位为V
+*/
+#if DAC80501_MATH == DAC80501_MATH_FIXED
+typedef int32_t DAC80501_Volt;
+#define DAC80501_VOLT(v) ((DAC80501_Volt)((v) * 1000000.0 + 0.5))
+#elif DAC80501_MATH == DAC80501_MATH_FLOAT
+typedef float DAC80501_Volt;
+#define DAC80501_VOLT(v) ((DAC80501_Volt)(v))
+#else
+typedef double DAC80501_Volt;
+#define DAC80501_VOLT(v) ((DAC80501_Volt)(v))
+#endif
+
+//定义DAC80501的输出量程，其数值即为内部参考电压数组的下标
+typedef enum
+{
+    DAC80501_RANGE_HALF = 0,    //分压比为2，增益为1，满量程为基准电压的一半
+    DAC80501_RANGE_UNITY,       //分压比为1，增益为1，满量程为基准电压
+    DAC80501_RANGE_DOUBLE       //分压比为1，增益为2，满量程为基准电压的两倍
+}DAC80501_Range;
+
 //DAC80501寄存器结构体声明
 typedef union _DAC80501_Reg_NOOP    DAC80501_Reg_NOOP;
 typedef union _DAC80501_Reg_DEVID   DAC80501_Reg_DEVID;
@@ -76,25 +234,74 @@ typedef union
 {
     struct
     {
-        uint8_t dev     : 1; //设备不存在
-        uint8_t malloc  : 1; //申请动态空间失败
-        uint8_t spi     : 1; //spi接口无效 
-        uint8_t sync    : 1; //sync#信号引脚无效
-        uint8_t gain    : 1; //缓冲放大器增益设置有误
-        uint8_t div     : 1; //基准电压源分压系数设置有误        
-        uint8_t ref_volt: 1; //基准电压源电压设置小于0
-        uint8_t out_volt: 1; //DAC输出电压电压超出了理论值
-        
+        uint16_t dev     : 1; //设备不存在
+        uint16_t malloc  : 1; //申请动态空间失败
+        uint16_t spi     : 1; //spi接口无效 
+        uint16_t sync    : 1; //sync#信号引脚无效
+        uint16_t gain    : 1; //缓冲放大器增益设置有误
+        uint16_t div     : 1; //基准电压源分压系数设置有误        
+        uint16_t ref_volt: 1; //基准电压源电压设置小于0
+        uint16_t out_volt: 1; //DAC输出电压电压超出了理论值
+        uint16_t param   : 1; //其他参数设置有误
+        uint16_t overflow: 1; //缓冲区已满
+        uint16_t         : 6;
     };
-    uint8_t data;
+    uint16_t data;
 }DAC80501_Error;    
 
+/*
+    定义DAC80501底层传输接口
+*/
+typedef struct
+{
+    //传输接口的私有数据，作为Write的第一个参数传入
+    void* handle;
+    
+    /*
+        连续发送count帧数据
+        frames: 每帧3字节，依次为寄存器地址、数据高字节、数据低字节
+        注意，每帧数据发送完成后都必须产生SYNC#上升沿
+    */
+    DAC80501_Error (* Write)(void* handle, const uint8_t* frames, const uint16_t count);
+}DAC80501_Transport;
+
+/*
+    定义热启动快照，由SaveSnapshot填充，应保存在MCU复位后仍保持内容的存储区中
+    注意，SPI模式下无法读取芯片寄存器，只有在快照保存后DAC80501一直保持供电时才能使用快照热启动
+*/
+#if DAC80501_ENABLE_SNAPSHOT
+typedef struct
+{
+    DAC80501_Volt ref_volt; //基准电压
+    DAC80501_Volt vout_set; //期望输出电压
+    uint32_t magic;         //快照标识
+    uint16_t sync;          //SYNC寄存器的值
+    uint16_t config;        //CONFIG寄存器的值
+    uint16_t gain;          //GAIN寄存器的值
+    uint16_t trigger;       //TRIGGER寄存器的值
+    uint16_t dac;           //DAC寄存器的值
+    uint16_t crc;           //以上所有成员的CRC-16校验值
+}DAC80501_Snapshot;
+#endif
+
 /*
     (3)定义DAC80501设备描述符
 */
 
 typedef struct _dac80501_t dac80501_t;
 
+#if DAC80501_ENABLE_PREPARED
+//预编码的设定点句柄，由PrepareDacOut填充，禁止直接修改其成员
+typedef struct
+{
+    dac80501_t* dev;        //预编码时使用的设备
+    uint8_t     frames[9];  //预编码的GAIN、DAC、GAIN数据帧
+    uint8_t     range;      //预编码时选择的量程
+    uint32_t    ref_gen;    //预编码时的基准电压版本
+    DAC80501_Volt vout;     //期望输出的电压，基准电压改变后用于重新编码
+}DAC80501_Prepared;
+#endif
+
 struct _dac80501_t
 {
     //实际可设置的寄存器指针，用于与DAC80501底层通信
@@ -108,21 +315,39 @@ struct _dac80501_t
 	//其他配置， 禁止直接写该配置结构体，否则可能导致未知错误
     DAC80501_Option *option;
     
+#if DAC80501_USE_STM32_HAL
     //SYNC信号描述
     GPIO_TypeDef*   sync_GPIO;    //SYNC#信号所属GPIO
     uint16_t        sync_BIT;     //SYNC#信号的位号
     
     //SPI接口描述符
     SPI_HandleTypeDef* hspi;
+#endif
+    
+    //底层传输接口，由Init或InitTransport绑定
+    DAC80501_Transport transport;
+    
+#if DAC80501_ENABLE_SNAPSHOT
+    //热启动快照，由SetWarmStart设置，禁止直接写
+    const DAC80501_Snapshot* warm_snapshot;
+#endif
     
     //操作接口
     
+#if DAC80501_USE_STM32_HAL
     /*
         初始化DAC80501, 
         对于spi接口，注意该函数绑定spi接口，但并不负责初始化对应的SPI接口
         对于SYNC#信号来说,也同样如此
     */
-    DAC80501_Error (* Init)(dac80501_t* dev,  SPI_HandleTypeDef *hspi,  GPIO_TypeDef* sync_GPIO, const uint16_t sync_BIT, double vout_default, void (*fun_callback)(void));
+    DAC80501_Error (* Init)(dac80501_t* dev,  SPI_HandleTypeDef *hspi,  GPIO_TypeDef* sync_GPIO, const uint16_t sync_BIT, DAC80501_Volt vout_default, void (*fun_callback)(void));
+#endif
+    
+    /*
+        以任意传输接口初始化DAC80501，传输接口的内容会被复制到设备描述符中
+        注意该函数并不负责初始化传输接口所使用的硬件
+    */
+    DAC80501_Error (* InitTransport)(dac80501_t* dev, const DAC80501_Transport* transport, DAC80501_Volt vout_default, void (*fun_callback)(void));
     
      /*
         反初始化DAC80501, 
@@ -133,8 +358,15 @@ struct _dac80501_t
     /*
         设置外部基准电压，注意调用该函数会自动禁用内部基准源
     */
-    DAC80501_Error(*SetRefVolt)(dac80501_t* dev, const double ref_volt);
+    DAC80501_Error(*SetRefVolt)(dac80501_t* dev, const DAC80501_Volt ref_volt);
 
+    /*
+        设置内部基准电压源
+        disable:只有最低位有效；最低位为0时使能内部基准源。
+    */
+    DAC80501_Error (* SetRefPower)(dac80501_t* dev, const uint8_t disable);
+    
+#if DAC80501_ENABLE_REG_API
     /*
         设置 SYNC 寄存器的 DAC_SYNC_EN 字段
         enable:只有最低位有效；最低位为1时，DAC输出设置为响应LDAC触发而更新（同步模式）。
@@ -142,12 +374,6 @@ struct _dac80501_t
     */
     DAC80501_Error (* SetDacSync)(dac80501_t* dev, const uint8_t enable);
     
-    /*
-        设置内部基准电压源
-        disable:只有最低位有效；最低位为0时使能内部基准源。
-    */
-    DAC80501_Error (* SetRefPower)(dac80501_t* dev, const uint8_t disable);
-    
      /*
         设置DAC输出使能
         disable:只有最低位有效；最低位为1时，DAC处于关断模式，DAC输出通过1 kΩ内部电阻连接至GND。
@@ -172,6 +398,8 @@ struct _dac80501_t
     */
     DAC80501_Error (* SetLDAC)(dac80501_t* dev, const uint8_t enable);
     
+#endif
+    
      /*
         软重置DAC80501芯片，DAC将恢复为默认上电状态
     */
@@ -182,7 +410,85 @@ struct _dac80501_t
         vout: 期望输出的电压
         注意，调用该函数时，会根据期望输出的电压动态的调节分压比和增益系数
     */
-    DAC80501_Error (* SetDacOut)(dac80501_t* dev, const double vout); 
+    DAC80501_Error (* SetDacOut)(dac80501_t* dev, const DAC80501_Volt vout); 
+    
+    /*
+        设置DAC输出量程
+        range: 取值见DAC80501_Range，非法时返回param错误；仅当量程与当前量程不同时才写入GAIN寄存器
+        注意，DAC数据寄存器不变，输出电压随满量程成比例变化（加倍或减半），不做防超调排序；
+        需要同时改变输出时应使用SetDacRangeCode，驱动内部及各扩展模块均不使用本接口
+    */
+    DAC80501_Error (* SetDacRange)(dac80501_t* dev, const uint8_t range);
+    
+    /*
+        同时设置DAC输出量程和DAC数据寄存器
+        range: 取值见DAC80501_Range，非法时返回param错误
+        code: 该量程下的16位DAC数据
+        量程变大时先写DAC数据，变小时先写GAIN，切换量程时中间输出不会超调
+    */
+    DAC80501_Error (* SetDacRangeCode)(dac80501_t* dev, const uint8_t range, const uint16_t code);
+    
+    /*
+        在当前量程下直接设置DAC数据寄存器
+        code: 16位DAC数据，不做电压换算，适合在定时器或DMA中断中高速刷新输出
+    */
+    DAC80501_Error (* SetDacCode)(dac80501_t* dev, const uint16_t code);
+    
+    /*
+        获取当前DAC输出量程
+        range: 用于保存量程的指针，取值见DAC80501_Range
+    */
+    DAC80501_Error (* GetDacRange)(dac80501_t* dev, uint8_t* range);
+    
+    /*
+        获取当前基准电压
+        ref_volt: 用于保存基准电压的指针，三个量程的满量程分别为其一半、一倍和两倍
+    */
+    DAC80501_Error (* GetRefVolt)(dac80501_t* dev, DAC80501_Volt* ref_volt);
+    
+#if DAC80501_ENABLE_PREPARED
+    /*
+        预编码DAC输出值
+        prepared: 用于保存预编码结果的句柄
+        vout: 期望输出的电压
+        句柄中保存当前基准电压下的GAIN和DAC数据帧，基准电压改变后ApplyPrepared会自动重新编码
+    */
+    DAC80501_Error (* PrepareDacOut)(dac80501_t* dev, DAC80501_Prepared* prepared, const DAC80501_Volt vout);
+    
+    /*
+        以预编码的句柄设置DAC输出值，只发送数据帧，量程未改变时只发送DAC数据帧
+        prepared: 必须已由本设备的PrepareDacOut填充，属于其他设备的句柄返回param错误
+    */
+    DAC80501_Error (* ApplyPrepared)(dac80501_t* dev, DAC80501_Prepared* prepared);
+    
+#endif
+    
+#if DAC80501_ENABLE_SNAPSHOT
+    /*
+        设置热启动快照，在Init或InitTransport之前调用
+        snapshot: 由SaveSnapshot保存的快照；快照有效时初始化过程不再软重置芯片，
+        只发送与vout_default不同的GAIN和DAC数据帧，快照无效时退回软重置；为NULL时冷启动
+        快照仅对下一次初始化有效
+    */
+    DAC80501_Error (* SetWarmStart)(dac80501_t* dev, const DAC80501_Snapshot* snapshot);
+    
+    /*
+        保存当前寄存器与配置到快照，应在每次更改配置或输出后调用
+    */
+    DAC80501_Error (* SaveSnapshot)(dac80501_t* dev, DAC80501_Snapshot* snapshot);
+    
+#endif
+    
+    /*
+        开始批量发送，此后写入的数据帧先缓存，直到EndBatch时一次提交给传输接口
+        允许嵌套调用，缓存已满时自动提交
+    */
+    DAC80501_Error (* BeginBatch)(dac80501_t* dev);
+    
+    /*
+        结束批量发送，最外层调用时提交所有缓存的数据帧
+    */
+    DAC80501_Error (* EndBatch)(dac80501_t* dev);
 };
 
 /*
@@ -191,6 +497,41 @@ struct _dac80501_t
 
 DAC80501_Error DAC80501_SPI_API_INIT(dac80501_t* dev);
 
+/*
+    (5)给出同时操作多个DAC80501的函数接口
+    各设备须先调用DAC80501_SPI_API_INIT绑定操作接口
+*/
+
+/*
+    同时软重置多个已初始化的DAC80501，效果与逐个调用SoftReset相同
+    devs: 设备指针数组
+    count: 设备个数
+    所有设备的复位命令连续发送，只等待一次复位完成时间，再依次恢复各设备的输出电压，
+    总耗时约为2ms，不随设备个数增加
+*/
+DAC80501_Error DAC80501_GroupSoftReset(dac80501_t* const* devs, const uint16_t count);
+
+/*
+    以任意传输接口同时初始化多个DAC80501，效果与逐个调用InitTransport相同
+    transports: 各设备的传输接口数组
+    vout_default: 各设备的默认输出电压数组
+    fun_callback: 所有设备初始化完成后调用一次
+    任一设备参数有误时直接返回，不发送任何数据；存储空间不足时释放已绑定的设备后返回；
+    设置了有效快照的设备热启动，不参与软重置
+*/
+DAC80501_Error DAC80501_GroupInitTransport(dac80501_t* const* devs, const DAC80501_Transport* transports, 
+	const DAC80501_Volt* vout_default, const uint16_t count, void (*fun_callback)(void));
+
+#if DAC80501_USE_STM32_HAL
+/*
+    以HAL库的SPI和SYNC#信号同时初始化多个DAC80501，效果与逐个调用Init相同
+    hspi、sync_GPIO、sync_BIT: 各设备的SPI接口、SYNC#信号所属GPIO及其位号数组
+    其他参数同DAC80501_GroupInitTransport
+*/
+DAC80501_Error DAC80501_GroupInit(dac80501_t* const* devs, SPI_HandleTypeDef* const* hspi, GPIO_TypeDef* const* sync_GPIO, 
+	const uint16_t* sync_BIT, const DAC80501_Volt* vout_default, const uint16_t count, void (*fun_callback)(void));
+#endif
+
 
 
 #ifdef __cplusplus
@@ -0,0 +1,203 @@
+#include "dac80501_spidev.h"
+#include "dac80501_private.h"
+
+#if DAC80501_ENABLE_SPIDEV
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+/*
+    （1）默认的系统调用接口
+*/
+
+static int Dac80501_Spidev_SysOpen(const char* path, int flags)
+{
+    return open(path, flags);
+}
+
+static int Dac80501_Spidev_SysClose(int fd)
+{
+    return close(fd);
+}
+
+static int Dac80501_Spidev_SysIoctl(int fd, unsigned long request, void* arg)
+{
+    return ioctl(fd, request, arg);
+}
+
+
+/*
+    （2）实现传输接口
+*/
+
+//连续发送count帧数据，每DAC80501_SPIDEV_MAX_XFER帧合并为一次ioctl
+static DAC80501_Error Dac80501_Spidev_Write(void* handle, const uint8_t* frames, const uint16_t count)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    dac80501_spidev_t* spidev = (dac80501_spidev_t*)handle;
+
+    //若传输接口不存在或设备未打开，直接返回
+    CHECK_PTR(spidev, error, spi);
+    if(spidev->fd < 0)
+    {
+        error.spi = 1;
+		DAC80501_PRINT_DEBUG("The spidev is not opened.\n");
+        return error;
+    }
+
+    struct spi_ioc_transfer xfer[DAC80501_SPIDEV_MAX_XFER];
+    uint16_t sent = 0;
+
+    while(sent < count)
+    {
+        uint16_t n = count - sent;
+        if(n > DAC80501_SPIDEV_MAX_XFER)
+            n = DAC80501_SPIDEV_MAX_XFER;
+
+        memset(xfer, 0, sizeof(struct spi_ioc_transfer) * n);
+
+        for(uint16_t i=0; i<n; i++)
+        {
+            xfer[i].tx_buf = (unsigned long)&frames[(sent + i) * 3];
+            xfer[i].len = 3;
+            xfer[i].speed_hz = spidev->speed_hz;
+            xfer[i].bits_per_word = 8;
+
+            //每帧之后释放片选，产生SYNC#上升沿；最后一帧由内核在消息结束时释放
+            xfer[i].cs_change = (i + 1 < n) ? 1 : 0;
+        }
+
+        if(spidev->sys_ioctl(spidev->fd, SPI_IOC_MESSAGE(n), xfer) < 0)
+        {
+            error.spi = 1;
+			DAC80501_PRINT_DEBUG("SPI_IOC_MESSAGE(%d) failed.\n", n);
+            return error;
+        }
+
+        sent += n;
+    }
+
+    return error;
+}
+
+
+/*
+    （3）实现提供给用户调用的应用层接口
+*/
+
+/*
+    打开并配置spidev设备
+*/
+static DAC80501_Error Dac80501_Spidev_Open(dac80501_spidev_t* spidev, const char* path, const uint32_t speed_hz)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若传输接口或路径不存在，直接返回
+    CHECK_PTR(spidev, error, spi);
+    CHECK_PTR(path, error, spi);
+
+    spidev->fd = spidev->sys_open(path, O_RDWR);
+    if(spidev->fd < 0)
+    {
+        error.spi = 1;
+		DAC80501_PRINT_DEBUG("Open %s failed.\n", path);
+        return error;
+    }
+
+    //DAC80501在SCLK下降沿锁存数据，使用SPI模式1
+    uint8_t mode = SPI_MODE_1;
+    uint8_t bits = 8;
+    uint32_t speed = speed_hz;
+
+    if((spidev->sys_ioctl(spidev->fd, SPI_IOC_WR_MODE, &mode) < 0) ||
+       (spidev->sys_ioctl(spidev->fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) ||
+       (spidev->sys_ioctl(spidev->fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0))
+    {
+        error.spi = 1;
+		DAC80501_PRINT_DEBUG("Configure %s failed.\n", path);
+        spidev->sys_close(spidev->fd);
+        spidev->fd = -1;
+        return error;
+    }
+
+    spidev->speed_hz = speed_hz;
+
+    return error;
+}
+
+/*
+    关闭spidev设备
+*/
+static DAC80501_Error Dac80501_Spidev_Close(dac80501_spidev_t* spidev)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若传输接口不存在，直接返回
+    CHECK_PTR(spidev, error, spi);
+
+    if(spidev->fd >= 0)
+    {
+        if(spidev->sys_close(spidev->fd) < 0)
+            error.spi = 1;
+
+        spidev->fd = -1;
+    }
+
+    return error;
+}
+
+/*
+    获取传输接口
+*/
+static DAC80501_Error Dac80501_Spidev_GetTransport(dac80501_spidev_t* spidev, DAC80501_Transport* transport)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若传输接口不存在，直接返回
+    CHECK_PTR(spidev, error, spi);
+    CHECK_PTR(transport, error, spi);
+
+    transport->handle = spidev;
+    transport->Write  = Dac80501_Spidev_Write;
+
+    return error;
+}
+
+
+/*
+    （4）给出初始化spidev传输接口的函数接口
+*/
+
+DAC80501_Error DAC80501_SPIDEV_API_INIT(dac80501_spidev_t* spidev)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    //若传输接口不存在，直接返回
+    CHECK_PTR(spidev, error, spi);
+
+    spidev->fd = -1;
+    spidev->speed_hz = 0;
+
+    //绑定系统调用接口
+    spidev->sys_open    = Dac80501_Spidev_SysOpen;
+    spidev->sys_close   = Dac80501_Spidev_SysClose;
+    spidev->sys_ioctl   = Dac80501_Spidev_SysIoctl;
+
+    //绑定函数接口
+    spidev->Open            = Dac80501_Spidev_Open;
+    spidev->Close           = Dac80501_Spidev_Close;
+    spidev->GetTransport    = Dac80501_Spidev_GetTransport;
+
+    return error;
+}
+
+#endif /* DAC80501_ENABLE_SPIDEV */
@@ -0,0 +1,76 @@
+#ifndef __DAC80501_SPIDEV_H__
+#define __DAC80501_SPIDEV_H__
+/*
+@filename   dac80501_spidev.h
+
+@brief		基于Linux spidev的DAC80501传输接口头文件
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    1.0
+
+@attention  本传输接口由内核控制片选信号（即SYNC#），需将DAC80501的SYNC#接至SPI控制器的片选引脚，
+            并在dac80501_spi_conf.h中将DAC80501_USE_STM32_HAL置为0。
+
+            （1）多帧数据合并为一次SPI_IOC_MESSAGE(N)系统调用提交，每帧为一个transfer，
+                 除最后一帧外均置位cs_change，使每帧之间产生SYNC#上升沿；
+            （2）open/close/ioctl均通过函数指针调用，DAC80501_SPIDEV_API_INIT将其设置为系统调用，
+                 测试时可在Open之前替换为记录传输内容的桩函数。
+*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//引入系统头文件
+#include <stdint.h>
+#include "dac80501_spi.h"
+
+//单次ioctl最多提交的数据帧数
+#define DAC80501_SPIDEV_MAX_XFER 64
+
+typedef struct _dac80501_spidev_t dac80501_spidev_t;
+
+struct _dac80501_spidev_t
+{
+    //以下成员由驱动内部维护，禁止直接修改
+    int         fd;         //spidev设备文件描述符
+    uint32_t    speed_hz;   //SCLK时钟频率
+
+    //系统调用接口，测试时可在Open之前替换
+    int (* sys_open)(const char* path, int flags);
+    int (* sys_close)(int fd);
+    int (* sys_ioctl)(int fd, unsigned long request, void* arg);
+
+    //操作接口
+
+    /*
+        打开并配置spidev设备
+        path: 设备文件路径，如"/dev/spidev0.0"
+        speed_hz: SCLK时钟频率，DAC80501最高支持50MHz
+    */
+    DAC80501_Error (* Open)(dac80501_spidev_t* spidev, const char* path, const uint32_t speed_hz);
+
+    /*
+        关闭spidev设备
+    */
+    DAC80501_Error (* Close)(dac80501_spidev_t* spidev);
+
+    /*
+        获取传输接口，可直接传给dac80501_t的InitTransport
+    */
+    DAC80501_Error (* GetTransport)(dac80501_spidev_t* spidev, DAC80501_Transport* transport);
+};
+
+/*
+    给出初始化spidev传输接口的函数接口
+*/
+
+DAC80501_Error DAC80501_SPIDEV_API_INIT(dac80501_spidev_t* spidev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DAC80501_SPIDEV_H__ */
@@ -21,16 +21,29 @@ extern "C" {
 #include <stdint.h>
 #include "delay.h"
 
-//打印调试信息日志开关
+//使用STM32 HAL库的SPI和GPIO接口作为传输接口，其他平台置为0并通过InitTransport绑定传输接口
+#define DAC80501_USE_STM32_HAL 1
+
+//批量发送时最多缓存的数据帧数
+#define DAC80501_BATCH_SIZE 8
+
+//功能裁剪配置，取值见dac80501_spi.h中的DAC80501_PROFILE_xxx
+//下列功能开关未在本文件中定义时按所选配置取默认值，在本文件中定义则覆盖默认值：
+//DAC80501_MATH、DAC80501_USE_MALLOC、DAC80501_MAX_DEVICES、DAC80501_ENABLE_REG_API、DAC80501_ENABLE_PREPARED、
+//DAC80501_ENABLE_SNAPSHOT、DAC80501_ENABLE_INTERP、DAC80501_ENABLE_DITHER、DAC80501_ENABLE_CTRL、
+//DAC80501_ENABLE_BULK、DAC80501_ENABLE_SPIDEV、DAC80501_ENABLE_SIM
+#define DAC80501_PROFILE DAC80501_PROFILE_FULL
+
+//打印调试信息日志开关，为0时不打印
 #define DAC80501_PRINT_DEBUG_INFO 1
 
 //必须提供延时1us的函数,以供满足SYNC的信号时序
 #define DAC80501_DELAY_1US do{delay_us(1);}while(0)
 
-//必须提供动态申请空间的函数，以满足初始化DAC80501的需求
+//DAC80501_USE_MALLOC为1时必须提供动态申请空间的函数，以满足初始化DAC80501的需求
 #define DAC80501_MALLOC(type) (type*)malloc(sizeof(type))
     
-//必须提供释放动态申请空间的函数，以满足反初始化DAC80501的需求
+//DAC80501_USE_MALLOC为1时必须提供释放动态申请空间的函数，以满足反初始化DAC80501的需求
 #define DAC80501_FREE(ptr)  do{\
                                 if(ptr)\
                                 {\
@@ -0,0 +1,410 @@
+/*
+@filename   dac80501_rig.c
+
+@brief		DAC80501多通道仿真测试台：以芯片模型代替硬件，在工作线程池中驱动大量虚拟通道回放设定点序列
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    1.0
+
+@attention  用法：dac80501_rig [-c 通道数] [-t 线程数] [-n 序列长度] [-f 序列文件] [-o 结果文件] [-s]
+            （1）所有通道以一次DAC80501_GroupInitTransport初始化，报告虚拟时钟耗时和实际耗时；
+            （2）每4个通道中有1个使用4.096V外部基准源，其余使用内部基准源；
+            （3）各通道以不同的相位回放同一个设定点序列，序列文件每行一个电压（单位V），以#开头的行被忽略，
+                 未给出序列文件时使用跨越三个量程的正弦与阶跃序列；
+            （4）-s时每个通道经spidev传输接口和桩函数访问芯片模型，否则直接使用芯片模型的传输接口；
+            （5）报告总吞吐量、每个设定点的数据帧数和各通道的输出误差，-o给出时按通道写出CSV结果；
+            （6）任一通道的误差超过0.5LSB（满量程限幅时为1LSB）、收到无效数据帧或接口返回错误时，返回值不为0。
+*/
+#include "dac80501_test.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+//工作线程每次领取的通道数
+#define RIG_BLOCK 64
+
+//外部基准电压
+#define RIG_EXT_REF 4.096
+
+typedef struct
+{
+    dac80501_t          dev;
+    dac80501_sim_t      sim;
+    dac80501_spidev_t   spidev;
+    double              ref_volt;       //通道使用的基准电压
+    uint32_t            phase;          //回放序列的起始位置
+
+    //回放结果
+    uint32_t            setpoints;
+    uint32_t            errors;
+    double              err_max;        //最大误差，单位V
+    double              err_sum;        //误差之和，单位V
+    double              err_max_lsb;    //最大误差，单位LSB
+}rig_channel_t;
+
+typedef struct
+{
+    rig_channel_t*  ch;
+    uint32_t        count;
+    const double*   trace;
+    uint32_t        trace_len;
+    uint32_t        next;               //下一个待领取的通道，原子访问
+}rig_t;
+
+//生成跨越三个量程的正弦与阶跃序列
+static double* Rig_DefaultTrace(uint32_t len)
+{
+    double* trace = malloc(sizeof(double) * len);
+    if(trace == NULL)
+        return NULL;
+
+    for(uint32_t i=0; i<len; i++)
+    {
+        double v;
+
+        if((i / 64) % 2)
+            v = 2.45 + 2.4 * sin(2 * M_PI * i / 97.0);
+        else
+            v = ((i / 8) % 4) * 1.3;
+
+        trace[i] = (v < 0) ? 0 : v;
+    }
+
+    return trace;
+}
+
+//读取序列文件，每行一个电压
+static double* Rig_LoadTrace(const char* path, uint32_t* len)
+{
+    FILE* fp = fopen(path, "r");
+    if(fp == NULL)
+        return NULL;
+
+    uint32_t cap = 1024, n = 0;
+    double* trace = malloc(sizeof(double) * cap);
+    char line[128];
+
+    while(trace && fgets(line, sizeof(line), fp))
+    {
+        double v;
+
+        if((line[0] == '#') || (sscanf(line, "%lf", &v) != 1))
+            continue;
+
+        if(n == cap)
+        {
+            double* grown = realloc(trace, sizeof(double) * cap * 2);
+            if(grown == NULL)
+            {
+                free(trace);
+                trace = NULL;
+                break;
+            }
+            trace = grown;
+            cap *= 2;
+        }
+
+        trace[n++] = v;
+    }
+
+    fclose(fp);
+
+    if(trace && (n == 0))
+    {
+        free(trace);
+        trace = NULL;
+    }
+
+    *len = n;
+    return trace;
+}
+
+//回放一个通道
+static void Rig_Replay(rig_t* rig, rig_channel_t* ch)
+{
+    for(uint32_t k=0; k<rig->trace_len; k++)
+    {
+        double v = rig->trace[(k + ch->phase) % rig->trace_len];
+        double vmax = (ch->ref_volt * 2 < DAC80501_MAX_VOUT) ? ch->ref_volt * 2 : DAC80501_MAX_VOUT;
+
+        if(v > vmax)
+            v = vmax;
+
+        DAC80501_Error error = ch->dev.SetDacOut(&ch->dev, DAC80501_VOLT(v));
+        ch->setpoints++;
+
+        if(error.data)
+        {
+            ch->errors++;
+            continue;
+        }
+
+        uint8_t range = 0;
+        double vout = 0;
+        ch->dev.GetDacRange(&ch->dev, &range);
+        ch->sim.GetVout(&ch->sim, &vout);
+
+        double fs = ch->ref_volt * (1 << range) / 2;
+        double lsb = fs / 65536;
+        double err = fabs(vout - v);
+        double err_lsb = err / lsb;
+
+        //满量程时DAC数据被限幅为65535，误差最大为1LSB
+        double limit = (v > fs - lsb / 2) ? 1.0 : 0.5;
+
+        if(err_lsb > limit + 1e-6)
+            ch->errors++;
+
+        if(err > ch->err_max)
+            ch->err_max = err;
+        if(err_lsb > ch->err_max_lsb)
+            ch->err_max_lsb = err_lsb;
+
+        ch->err_sum += err;
+    }
+}
+
+//工作线程，按块领取通道
+static void* Rig_Worker(void* arg)
+{
+    rig_t* rig = (rig_t*)arg;
+
+    for(;;)
+    {
+        uint32_t first = __atomic_fetch_add(&rig->next, RIG_BLOCK, __ATOMIC_RELAXED);
+        if(first >= rig->count)
+            break;
+
+        uint32_t last = (first + RIG_BLOCK < rig->count) ? first + RIG_BLOCK : rig->count;
+
+        for(uint32_t i=first; i<last; i++)
+            Rig_Replay(rig, &rig->ch[i]);
+    }
+
+    return NULL;
+}
+
+static void Rig_Usage(const char* name)
+{
+    printf("usage: %s [-c channels] [-t threads] [-n trace_len] [-f trace_file] [-o result_csv] [-s]\n", name);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t count = 4096;
+    uint32_t threads = 0;
+    uint32_t trace_len = 4096;
+    const char* trace_path = NULL;
+    const char* out_path = NULL;
+    int use_spidev = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "c:t:n:f:o:sh")) != -1)
+    {
+        switch(opt)
+        {
+            case 'c': count = strtoul(optarg, NULL, 0); break;
+            case 't': threads = strtoul(optarg, NULL, 0); break;
+            case 'n': trace_len = strtoul(optarg, NULL, 0); break;
+            case 'f': trace_path = optarg; break;
+            case 'o': out_path = optarg; break;
+            case 's': use_spidev = 1; break;
+            default: Rig_Usage(argv[0]); return 2;
+        }
+    }
+
+    //GroupInitTransport的设备个数为16位
+    if((count == 0) || (count > UINT16_MAX) || (trace_len == 0))
+    {
+        Rig_Usage(argv[0]);
+        return 2;
+    }
+
+    if(threads == 0)
+    {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (n > 0) ? (uint32_t)n : 1;
+    }
+
+    rig_t rig;
+    memset(&rig, 0, sizeof(rig));
+
+    rig.trace = trace_path ? Rig_LoadTrace(trace_path, &trace_len) : Rig_DefaultTrace(trace_len);
+    rig.trace_len = trace_len;
+    if(rig.trace == NULL)
+    {
+        printf("cannot load trace %s\n", trace_path ? trace_path : "(default)");
+        return 2;
+    }
+
+    rig.count = count;
+    rig.ch = calloc(count, sizeof(rig_channel_t));
+    dac80501_t** devs = calloc(count, sizeof(dac80501_t*));
+    DAC80501_Transport* transports = calloc(count, sizeof(DAC80501_Transport));
+    DAC80501_Volt* vout_default = calloc(count, sizeof(DAC80501_Volt));
+
+    if(!rig.ch || !devs || !transports || !vout_default)
+    {
+        printf("out of memory\n");
+        return 2;
+    }
+
+    //准备芯片模型和传输接口
+    for(uint32_t i=0; i<count; i++)
+    {
+        rig_channel_t* ch = &rig.ch[i];
+
+        ch->ref_volt = (i % 4 == 3) ? RIG_EXT_REF : DAC80501_INTERNAL_VREF;
+        ch->phase = (uint32_t)(((uint64_t)i * 7919) % trace_len);
+
+        DAC80501_SIM_API_INIT(&ch->sim);
+        ch->sim.Init(&ch->sim, RIG_EXT_REF);
+
+        if(use_spidev)
+        {
+            char path[32];
+            snprintf(path, sizeof(path), "sim:%d", Dac80501_FakeSpidevAttach(&ch->sim));
+
+            DAC80501_SPIDEV_API_INIT(&ch->spidev);
+            Dac80501_FakeSpidevBind(&ch->spidev);
+
+            if(ch->spidev.Open(&ch->spidev, path, 10000000).data)
+            {
+                printf("cannot open %s\n", path);
+                return 2;
+            }
+
+            ch->spidev.GetTransport(&ch->spidev, &transports[i]);
+        }
+        else
+            ch->sim.GetTransport(&ch->sim, &transports[i]);
+
+        DAC80501_SPI_API_INIT(&ch->dev);
+        devs[i] = &ch->dev;
+        vout_default[i] = DAC80501_VOLT(0);
+    }
+
+    //一次初始化所有通道
+    uint64_t clock0 = Dac80501_TestClock();
+    uint64_t ns0 = Dac80501_TestNanos();
+    DAC80501_Error error = DAC80501_GroupInitTransport(devs, transports, vout_default, (uint16_t)count, NULL);
+    uint64_t ns1 = Dac80501_TestNanos();
+    uint64_t clock1 = Dac80501_TestClock();
+
+    uint64_t init_frames = 0;
+    for(uint32_t i=0; i<count; i++)
+        init_frames += rig.ch[i].sim.frames;
+
+    printf("init: %u channels, %s transport, virtual %llu us, wall %.3f ms, %llu frames\n",
+        count, use_spidev ? "spidev" : "sim", (unsigned long long)(clock1 - clock0),
+        (ns1 - ns0) / 1e6, (unsigned long long)init_frames);
+
+    if(error.data)
+    {
+        printf("FAIL init error 0x%04x\n", error.data);
+        return 1;
+    }
+
+    for(uint32_t i=0; i<count; i++)
+    {
+        rig_channel_t* ch = &rig.ch[i];
+
+        if(ch->ref_volt != DAC80501_INTERNAL_VREF)
+            error.data |= ch->dev.SetRefVolt(&ch->dev, DAC80501_VOLT(ch->ref_volt)).data;
+
+        ch->sim.ClearStats(&ch->sim);
+    }
+
+    if(error.data)
+    {
+        printf("FAIL SetRefVolt error 0x%04x\n", error.data);
+        return 1;
+    }
+
+    //工作线程池回放设定点序列
+    pthread_t* pool = calloc(threads, sizeof(pthread_t));
+    uint32_t messages0 = Dac80501_FakeSpidevMessages();
+
+    ns0 = Dac80501_TestNanos();
+    for(uint32_t t=0; t<threads; t++)
+        pthread_create(&pool[t], NULL, Rig_Worker, &rig);
+    for(uint32_t t=0; t<threads; t++)
+        pthread_join(pool[t], NULL);
+    ns1 = Dac80501_TestNanos();
+
+    //汇总结果
+    uint64_t setpoints = 0, frames = 0, writes = 0, errors = 0, bad_frames = 0;
+    double err_max = 0, err_max_lsb = 0, err_sum = 0, peak = 0;
+    uint32_t worst = 0;
+
+    FILE* out = out_path ? fopen(out_path, "w") : NULL;
+    if(out)
+        fprintf(out, "channel,ref_volt,setpoints,frames,errors,err_max_uv,err_mean_uv,err_max_lsb\n");
+
+    for(uint32_t i=0; i<count; i++)
+    {
+        rig_channel_t* ch = &rig.ch[i];
+
+        setpoints   += ch->setpoints;
+        frames      += ch->sim.frames;
+        writes      += ch->sim.writes;
+        errors      += ch->errors;
+        bad_frames  += ch->sim.bad_frames;
+        err_sum     += ch->err_sum;
+
+        if(ch->err_max_lsb > err_max_lsb)
+        {
+            err_max_lsb = ch->err_max_lsb;
+            worst = i;
+        }
+        if(ch->err_max > err_max)
+            err_max = ch->err_max;
+        if(ch->sim.vout_peak > peak)
+            peak = ch->sim.vout_peak;
+
+        if(out)
+            fprintf(out, "%u,%.3f,%u,%u,%u,%.3f,%.3f,%.4f\n", i, ch->ref_volt, ch->setpoints, ch->sim.frames,
+                ch->errors, ch->err_max * 1e6, ch->err_sum * 1e6 / ch->setpoints, ch->err_max_lsb);
+    }
+
+    if(out)
+        fclose(out);
+
+    double sec = (ns1 - ns0) / 1e9;
+
+    printf("replay: %u threads, trace %u points, %llu setpoints in %.3f s\n", threads, trace_len, (unsigned long long)setpoints, sec);
+    printf("throughput: %.0f setpoints/s, %.0f frames/s\n", setpoints / sec, frames / sec);
+    printf("bus: %.3f frames/setpoint, %.3f writes/setpoint", (double)frames / setpoints, (double)writes / setpoints);
+    if(use_spidev)
+        printf(", %.3f ioctls/setpoint", (double)(Dac80501_FakeSpidevMessages() - messages0) / setpoints);
+    printf("\n");
+    printf("error: max %.3f uV, mean %.3f uV, max %.4f LSB (channel %u, ref %.3f V)\n",
+        err_max * 1e6, err_sum * 1e6 / setpoints, err_max_lsb, worst, rig.ch[worst].ref_volt);
+    printf("check: %llu errors, %llu bad frames, %u spidev cs errors, peak %.4f V\n",
+        (unsigned long long)errors, (unsigned long long)bad_frames, Dac80501_FakeSpidevErrors(), peak);
+
+    for(uint32_t i=0; i<count; i++)
+    {
+        rig.ch[i].dev.DeInit(&rig.ch[i].dev, NULL);
+        if(use_spidev)
+            rig.ch[i].spidev.Close(&rig.ch[i].spidev);
+    }
+
+    int fail = (errors != 0) || (bad_frames != 0) || (Dac80501_FakeSpidevErrors() != 0);
+    printf("%s\n", fail ? "FAIL" : "PASS");
+
+    free(pool);
+    free(vout_default);
+    free(transports);
+    free(devs);
+    free(rig.ch);
+    free((void*)rig.trace);
+
+    return fail;
+}
@@ -0,0 +1,66 @@
+#ifndef __DAC80501_SPI_CONF__H__
+#define __DAC80501_SPI_CONF__H__
+/*
+@filename   dac80501_spi_conf.h
+
+@brief		主机测试使用的DAC80501驱动配置头文件，以芯片模型作为传输接口
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@attention  功能裁剪配置由构建系统以-DDAC80501_PROFILE=x给出，同一份测试可对各配置分别编译；
+            延时函数只推进测试的虚拟时钟，不实际等待，以便统计初始化耗时；
+            内存屏障之后可插入测试登记的模拟中断。
+*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdlib.h>
+
+//主机上不使用STM32 HAL库
+#define DAC80501_USE_STM32_HAL 0
+
+//批量发送时最多缓存的数据帧数
+#define DAC80501_BATCH_SIZE 8
+
+//功能裁剪配置，未由构建系统给出时使用完整配置
+#ifndef DAC80501_PROFILE
+#define DAC80501_PROFILE DAC80501_PROFILE_FULL
+#endif
+
+//静态分配空间时的存储池大小，须容纳测试同时使用的设备数
+#ifndef DAC80501_MAX_DEVICES
+#define DAC80501_MAX_DEVICES 64
+#endif
+
+//测试时不打印调试信息
+#define DAC80501_PRINT_DEBUG_INFO 0
+
+//延时1us只推进虚拟时钟，由dac80501_test.c实现
+void Dac80501_TestDelay1us(void);
+#define DAC80501_DELAY_1US do{Dac80501_TestDelay1us();}while(0)
+
+//内存屏障之后调用测试登记的模拟中断，用于检查中断在两次写入之间到来时的行为，由dac80501_test.c实现
+void Dac80501_TestPreempt(void);
+#define DAC80501_MEMORY_BARRIER() do{__atomic_thread_fence(__ATOMIC_SEQ_CST); Dac80501_TestPreempt();}while(0)
+
+//动态申请空间的函数
+#define DAC80501_MALLOC(type) (type*)malloc(sizeof(type))
+    
+//释放动态申请空间的函数
+#define DAC80501_FREE(ptr)  do{\
+                                if(ptr)\
+                                {\
+                                    free(ptr);\
+                                    ptr = NULL;\
+                                }\
+                            }while(0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DAC80501_SPI_CONF__H__ */
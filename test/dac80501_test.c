@@ -0,0 +1,257 @@
+#include "dac80501_test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+uint32_t dac80501_test_failures = 0;
+
+/*
+    （1）虚拟时钟
+*/
+
+static uint64_t dac80501_test_clock = 0;
+
+//由DAC80501_DELAY_1US调用；工作线程不会调用延时，但仍以原子操作累加
+void Dac80501_TestDelay1us(void)
+{
+    __atomic_fetch_add(&dac80501_test_clock, 1, __ATOMIC_RELAXED);
+}
+
+uint64_t Dac80501_TestClock(void)
+{
+    return __atomic_load_n(&dac80501_test_clock, __ATOMIC_RELAXED);
+}
+
+uint64_t Dac80501_TestNanos(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+
+/*
+    （2）逐帧探针传输接口
+*/
+
+//逐帧转发给芯片模型，并记录每帧之后的输出电压
+static DAC80501_Error Dac80501_ProbeWrite(void* handle, const uint8_t* frames, const uint16_t count)
+{
+    DAC80501_Error error;
+    error.data = 0;
+
+    dac80501_probe_t* probe = (dac80501_probe_t*)handle;
+    probe->writes++;
+
+    for(uint16_t i=0; i<count; i++)
+    {
+        error = probe->inner.Write(probe->inner.handle, &frames[i * 3], 1);
+        if(error.data)
+            return error;
+
+        double vout = Dac80501_ProbeVout(probe);
+
+        if(vout > probe->vout_max)
+            probe->vout_max = vout;
+        if(vout < probe->vout_min)
+            probe->vout_min = vout;
+        if(probe->log_count < DAC80501_PROBE_LOG)
+            probe->log[probe->log_count++] = vout;
+
+        probe->frames++;
+    }
+
+    return error;
+}
+
+void Dac80501_ProbeInit(dac80501_probe_t* probe, const double ext_ref)
+{
+    memset(probe, 0, sizeof(dac80501_probe_t));
+
+    DAC80501_SIM_API_INIT(&probe->sim);
+    probe->sim.Init(&probe->sim, ext_ref);
+    probe->sim.GetTransport(&probe->sim, &probe->inner);
+
+    Dac80501_ProbeClear(probe);
+}
+
+void Dac80501_ProbeClear(dac80501_probe_t* probe)
+{
+    double vout = Dac80501_ProbeVout(probe);
+
+    probe->writes       = 0;
+    probe->frames       = 0;
+    probe->vout_max     = vout;
+    probe->vout_min     = vout;
+    probe->log_count    = 0;
+}
+
+DAC80501_Transport Dac80501_ProbeTransport(dac80501_probe_t* probe)
+{
+    DAC80501_Transport transport;
+
+    transport.handle = probe;
+    transport.Write  = Dac80501_ProbeWrite;
+
+    return transport;
+}
+
+DAC80501_Error Dac80501_ProbeOpen(dac80501_probe_t* probe, dac80501_t* dev, const DAC80501_Volt vout_default)
+{
+    DAC80501_Transport transport = Dac80501_ProbeTransport(probe);
+
+    DAC80501_SPI_API_INIT(dev);
+    DAC80501_Error error = dev->InitTransport(dev, &transport, vout_default, NULL);
+
+    Dac80501_ProbeClear(probe);
+
+    return error;
+}
+
+double Dac80501_ProbeVout(dac80501_probe_t* probe)
+{
+    double vout = 0;
+    probe->sim.GetVout(&probe->sim, &vout);
+
+    return vout;
+}
+
+
+//只累加数据帧数的传输接口
+static DAC80501_Error Dac80501_CountWrite(void* handle, const uint8_t* frames, const uint16_t count)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    (void)frames;
+
+    *(uint32_t*)handle += count;
+
+    return error;
+}
+
+DAC80501_Transport Dac80501_CountTransport(uint32_t* frames)
+{
+    DAC80501_Transport transport = {frames, Dac80501_CountWrite};
+
+    return transport;
+}
+
+
+/*
+    （3）spidev桩函数
+*/
+
+//桩函数返回的文件描述符从该值开始，避免与标准输入输出混淆
+#define DAC80501_FAKE_FD_BASE 100
+
+static dac80501_sim_t** dac80501_fake_sims = NULL;
+static int dac80501_fake_count = 0;
+static uint32_t dac80501_fake_messages = 0;
+static uint32_t dac80501_fake_errors = 0;
+
+int Dac80501_FakeSpidevAttach(dac80501_sim_t* sim)
+{
+    dac80501_sim_t** sims = realloc(dac80501_fake_sims, sizeof(dac80501_sim_t*) * (dac80501_fake_count + 1));
+    if(sims == NULL)
+        return -1;
+
+    dac80501_fake_sims = sims;
+    dac80501_fake_sims[dac80501_fake_count] = sim;
+
+    return dac80501_fake_count++;
+}
+
+static int Dac80501_FakeOpen(const char* path, int flags)
+{
+    (void)flags;
+    int index;
+
+    if((sscanf(path, "sim:%d", &index) != 1) || (index < 0) || (index >= dac80501_fake_count))
+        return -1;
+
+    return DAC80501_FAKE_FD_BASE + index;
+}
+
+static int Dac80501_FakeClose(int fd)
+{
+    return ((fd >= DAC80501_FAKE_FD_BASE) && (fd < DAC80501_FAKE_FD_BASE + dac80501_fake_count)) ? 0 : -1;
+}
+
+static int Dac80501_FakeIoctl(int fd, unsigned long request, void* arg)
+{
+    int index = fd - DAC80501_FAKE_FD_BASE;
+
+    if((index < 0) || (index >= dac80501_fake_count))
+        return -1;
+
+    //配置类ioctl直接返回成功
+    if((request == SPI_IOC_WR_MODE) || (request == SPI_IOC_WR_BITS_PER_WORD) || (request == SPI_IOC_WR_MAX_SPEED_HZ))
+        return 0;
+
+    if(_IOC_TYPE(request) != SPI_IOC_MAGIC || _IOC_NR(request) != 0)
+        return -1;
+
+    const struct spi_ioc_transfer* xfer = (const struct spi_ioc_transfer*)arg;
+    uint32_t n = _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer);
+
+    dac80501_sim_t* sim = dac80501_fake_sims[index];
+    DAC80501_Transport transport;
+    sim->GetTransport(sim, &transport);
+
+    __atomic_fetch_add(&dac80501_fake_messages, 1, __ATOMIC_RELAXED);
+
+    for(uint32_t i=0; i<n; i++)
+    {
+        //每帧之间必须释放片选，否则芯片会把相邻两帧当作一帧
+        if((xfer[i].len != 3) || ((i + 1 < n) && !xfer[i].cs_change))
+            __atomic_fetch_add(&dac80501_fake_errors, 1, __ATOMIC_RELAXED);
+
+        transport.Write(transport.handle, (const uint8_t*)(uintptr_t)xfer[i].tx_buf, 1);
+    }
+
+    return (int)(n * 3);
+}
+
+void Dac80501_FakeSpidevBind(dac80501_spidev_t* spidev)
+{
+    spidev->sys_open    = Dac80501_FakeOpen;
+    spidev->sys_close   = Dac80501_FakeClose;
+    spidev->sys_ioctl   = Dac80501_FakeIoctl;
+}
+
+uint32_t Dac80501_FakeSpidevMessages(void)
+{
+    return __atomic_load_n(&dac80501_fake_messages, __ATOMIC_RELAXED);
+}
+
+uint32_t Dac80501_FakeSpidevErrors(void)
+{
+    return __atomic_load_n(&dac80501_fake_errors, __ATOMIC_RELAXED);
+}
+
+
+/*
+    （4）模拟中断
+*/
+
+static void (* dac80501_test_isr)(void* arg) = NULL;
+static void* dac80501_test_isr_arg = NULL;
+
+void Dac80501_TestSetPreempt(void (* isr)(void* arg), void* arg)
+{
+    dac80501_test_isr_arg = arg;
+    __atomic_store_n(&dac80501_test_isr, isr, __ATOMIC_RELEASE);
+}
+
+//由DAC80501_MEMORY_BARRIER调用；工作线程也会执行内存屏障，因此以原子操作读取
+void Dac80501_TestPreempt(void)
+{
+    void (* isr)(void* arg) = __atomic_load_n(&dac80501_test_isr, __ATOMIC_ACQUIRE);
+
+    if(isr)
+        isr(dac80501_test_isr_arg);
+}
@@ -0,0 +1,164 @@
+#ifndef __DAC80501_TEST_H__
+#define __DAC80501_TEST_H__
+/*
+@filename   dac80501_test.h
+
+@brief		DAC80501主机测试的公共部分：断言、虚拟时钟、逐帧探针传输接口、spidev桩函数和模拟中断
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@version    1.0
+
+@attention  （1）虚拟时钟由配置文件中的DAC80501_DELAY_1US推进，单位us，用于统计初始化等操作的耗时；
+            （2）探针传输接口把每次提交的数据帧逐帧转发给芯片模型，并在每帧之后记录输出电压，
+                 用于检查切换量程等操作的中间输出；
+            （3）spidev桩函数把SPI_IOC_MESSAGE中的每个transfer解码为一帧，转发给路径对应的芯片模型，
+                 路径格式为"sim:<序号>"，序号为Dac80501_FakeSpidevAttach登记芯片模型时的下标；
+            （4）模拟中断在驱动的内存屏障之后同步调用，用于在SetKernel等操作的两次写入之间插入Step。
+*/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//引入系统头文件
+#include <stdint.h>
+#include <stdio.h>
+#include "dac80501_spi.h"
+#include "dac80501_sim.h"
+#include "dac80501_spidev.h"
+
+/*
+    （1）断言
+*/
+
+//失败的断言个数，main返回时以其判断测试结果
+extern uint32_t dac80501_test_failures;
+
+#define TEST_CHECK(cond, fmt, args...) do{\
+                                        if(!(cond))\
+                                        {\
+                                            dac80501_test_failures++;\
+                                            printf("FAIL %s(%d): " fmt "\n", __FILE__, __LINE__, ##args);\
+                                        }\
+                                    }while(0)
+
+//打印测试结果，作为main的返回值
+#define TEST_REPORT(name) (printf("%s: %s, %u failures\n", name, dac80501_test_failures ? "FAIL" : "PASS",\
+                            dac80501_test_failures), dac80501_test_failures != 0)
+
+//将DAC80501_Volt转换为以V为单位的double
+#if DAC80501_MATH == DAC80501_MATH_FIXED
+#define TEST_VOLT(v) ((double)(v) / 1000000.0)
+#else
+#define TEST_VOLT(v) ((double)(v))
+#endif
+
+//各量程的1LSB，单位V
+#define TEST_LSB(ref_volt, range) (((ref_volt) * (double)(1 << (range)) / 2) / 65536)
+
+/*
+    （2）虚拟时钟
+*/
+
+//获取虚拟时钟，单位us
+uint64_t Dac80501_TestClock(void);
+
+//获取主机单调时钟，单位ns，用于统计吞吐量
+uint64_t Dac80501_TestNanos(void);
+
+//读取CPU时间戳计数器，用于统计单次调用的周期数；非x86平台返回0
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TEST_CYCLES() __rdtsc()
+#else
+#define TEST_CYCLES() 0
+#endif
+
+/*
+    （3）逐帧探针传输接口
+*/
+
+//探针最多记录的输出电压个数
+#define DAC80501_PROBE_LOG 32
+
+typedef struct
+{
+    dac80501_sim_t  sim;                        //被探测的芯片模型
+    DAC80501_Transport inner;                   //芯片模型的传输接口
+    uint32_t        writes;                     //传输接口的调用次数
+    uint32_t        frames;                     //收到的数据帧数
+    double          vout_max;                   //每帧之后输出电压的最大值
+    double          vout_min;                   //每帧之后输出电压的最小值
+    double          log[DAC80501_PROBE_LOG];    //每帧之后的输出电压
+    uint16_t        log_count;                  //已记录的输出电压个数
+}dac80501_probe_t;
+
+/*
+    初始化探针及其芯片模型
+    ext_ref: 芯片模型的外部基准电压，单位V
+*/
+void Dac80501_ProbeInit(dac80501_probe_t* probe, const double ext_ref);
+
+/*
+    清空记录，最大值和最小值置为当前输出电压
+*/
+void Dac80501_ProbeClear(dac80501_probe_t* probe);
+
+/*
+    获取探针的传输接口，可直接传给InitTransport
+*/
+DAC80501_Transport Dac80501_ProbeTransport(dac80501_probe_t* probe);
+
+/*
+    以探针的传输接口初始化设备，初始化完成后清空记录
+    vout_default: 默认输出电压
+*/
+DAC80501_Error Dac80501_ProbeOpen(dac80501_probe_t* probe, dac80501_t* dev, const DAC80501_Volt vout_default);
+
+//获取探针芯片模型的当前输出电压，单位V
+double Dac80501_ProbeVout(dac80501_probe_t* probe);
+
+/*
+    获取只计数的传输接口，不转发给芯片模型，用于统计驱动本身的耗时
+    frames: 累加收到的数据帧数
+*/
+DAC80501_Transport Dac80501_CountTransport(uint32_t* frames);
+
+/*
+    （4）spidev桩函数
+*/
+
+/*
+    登记芯片模型，返回其序号；登记的芯片模型须在测试结束前保持有效
+*/
+int Dac80501_FakeSpidevAttach(dac80501_sim_t* sim);
+
+/*
+    以桩函数替换spidev的系统调用，须在DAC80501_SPIDEV_API_INIT之后、Open之前调用
+*/
+void Dac80501_FakeSpidevBind(dac80501_spidev_t* spidev);
+
+//桩函数收到的SPI_IOC_MESSAGE次数
+uint32_t Dac80501_FakeSpidevMessages(void);
+
+//桩函数收到的片选时序错误的transfer个数（非最后一个transfer未置位cs_change，或长度不为3）
+uint32_t Dac80501_FakeSpidevErrors(void);
+
+/*
+    （5）模拟中断
+*/
+
+/*
+    登记模拟中断，驱动每次执行DAC80501_MEMORY_BARRIER后调用一次
+    isr: 中断函数，为NULL时取消登记
+    arg: 传给中断函数的参数
+*/
+void Dac80501_TestSetPreempt(void (* isr)(void* arg), void* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DAC80501_TEST_H__ */
@@ -0,0 +1,208 @@
+/*
+@filename   test_bulk.c
+
+@brief		批量换算模块测试：各基准电压下与SetDacOut逐个换算的结果一致、整个数组一次换算与逐个换算一致，并比较各换算方式每秒可换算的点数
+
+@time		2026/10/18
+
+@author		丁鹏龙
+*/
+#include "dac80501_test.h"
+#include "dac80501_bulk.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_SAMPLES    100000
+#define TEST_BENCH_LEN  4096
+#define TEST_BENCH_REP  200
+#define TEST_BATCH_LEN  4093    //不是SIMD通道数的整数倍，覆盖向量部分和剩余的逐点部分
+
+//只记录最后一个DAC数据帧的传输接口，作为SetDacOut的参照
+static uint8_t test_last[3];
+
+static DAC80501_Error Test_Record(void* handle, const uint8_t* frames, const uint16_t count)
+{
+    DAC80501_Error error;
+    error.data = 0;
+    (void)handle;
+
+    for(uint16_t i=0; i<count; i++)
+        if(frames[i * 3] == 0x08)
+            memcpy(test_last, &frames[i * 3], 3);
+
+    return error;
+}
+
+//电压的uV值转换为DAC80501_Volt
+static DAC80501_Volt Test_Volt(int32_t uv)
+{
+#if DAC80501_MATH == DAC80501_MATH_FIXED
+    return uv;
+#else
+    return (DAC80501_Volt)(uv / 1e6);
+#endif
+}
+
+//比较整个数组一次换算与逐个换算的DAC数据帧和量程
+static int Test_Compare(const uint8_t* frames, const uint8_t* ranges, const uint8_t* one_frames, const uint8_t* one_ranges)
+{
+    return (memcmp(frames, one_frames, TEST_BATCH_LEN * 3) == 0) && (memcmp(ranges, one_ranges, TEST_BATCH_LEN) == 0);
+}
+
+//整个数组一次换算，使向量实现和剩余的逐点循环都参与比较，结果须与逐个换算一致
+static void Test_Batch(dac80501_bulk_t* bulk, int32_t limit, double ref)
+{
+    static int32_t uv[TEST_BATCH_LEN];
+    static uint8_t frames[TEST_BATCH_LEN * 3], ranges[TEST_BATCH_LEN];
+    static uint8_t one_frames[TEST_BATCH_LEN * 3], one_ranges[TEST_BATCH_LEN];
+
+    srand(2);
+    for(int i=0; i<TEST_BATCH_LEN; i++)
+        uv[i] = (i & 1) ? (int32_t)((int64_t)i * limit / (TEST_BATCH_LEN - 1)) : (int32_t)((double)rand() / RAND_MAX * limit);
+
+    TEST_CHECK(bulk->EncodeMicrovolt(bulk, uv, TEST_BATCH_LEN, frames, ranges).data == 0, "ref %.3f: batch error", ref);
+    for(int i=0; i<TEST_BATCH_LEN; i++)
+        bulk->EncodeMicrovolt(bulk, &uv[i], 1, &one_frames[i * 3], &one_ranges[i]);
+    TEST_CHECK(Test_Compare(frames, ranges, one_frames, one_ranges), "ref %.3f: EncodeMicrovolt batch differs", ref);
+
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+    static double v[TEST_BATCH_LEN];
+    static float f[TEST_BATCH_LEN];
+    for(int i=0; i<TEST_BATCH_LEN; i++)
+    {
+        v[i] = uv[i] / 1e6;
+        f[i] = (float)v[i];
+    }
+
+    TEST_CHECK(bulk->EncodeDouble(bulk, v, TEST_BATCH_LEN, frames, ranges).data == 0, "ref %.3f: batch error", ref);
+    for(int i=0; i<TEST_BATCH_LEN; i++)
+        bulk->EncodeDouble(bulk, &v[i], 1, &one_frames[i * 3], &one_ranges[i]);
+    TEST_CHECK(Test_Compare(frames, ranges, one_frames, one_ranges), "ref %.3f: EncodeDouble batch differs", ref);
+
+    bulk->EncodeFloat(bulk, f, TEST_BATCH_LEN, frames, ranges);
+    for(int i=0; i<TEST_BATCH_LEN; i++)
+        bulk->EncodeFloat(bulk, &f[i], 1, &one_frames[i * 3], &one_ranges[i]);
+    TEST_CHECK(Test_Compare(frames, ranges, one_frames, one_ranges), "ref %.3f: EncodeFloat batch differs", ref);
+#endif
+}
+
+static void Test_Parity(dac80501_t* dev, double ref)
+{
+    dac80501_bulk_t bulk;
+    DAC80501_BULK_API_INIT(&bulk);
+    TEST_CHECK(bulk.Init(&bulk, dev).data == 0, "bulk init ref %.3f", ref);
+
+    double vmax = (ref * 2 < DAC80501_MAX_VOUT) ? ref * 2 : DAC80501_MAX_VOUT;
+    int32_t limit = (int32_t)(vmax * 1e6);
+    uint32_t mismatch = 0;
+
+    srand(1);
+    for(int k=0; k<TEST_SAMPLES; k++)
+    {
+        //先扫描全范围，再取随机值
+        int32_t uv = (k < 4000) ? (int32_t)((int64_t)k * limit / 3999) : (int32_t)((double)rand() / RAND_MAX * limit);
+        uint8_t frame[3], range, cur;
+
+        bulk.EncodeMicrovolt(&bulk, &uv, 1, frame, &range);
+
+        if(dev->SetDacOut(dev, Test_Volt(uv)).data)
+            continue;
+        dev->GetDacRange(dev, &cur);
+
+        if(memcmp(frame, test_last, 3) || (range != cur))
+        {
+            if(mismatch < 3)
+                printf("ref %.3f: %d uV bulk %02x%02x/%u, SetDacOut %02x%02x/%u\n", ref, uv,
+                    frame[1], frame[2], range, test_last[1], test_last[2], cur);
+            mismatch++;
+        }
+
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+        double v = uv / 1e6;
+        bulk.EncodeDouble(&bulk, &v, 1, frame, &range);
+        if(memcmp(frame, test_last, 3) || (range != cur))
+            mismatch++;
+#endif
+    }
+
+    TEST_CHECK(mismatch == 0, "ref %.3f: %u mismatches", ref, mismatch);
+
+    Test_Batch(&bulk, limit, ref);
+
+    //超出范围的电压被限幅并返回out_volt错误
+    int32_t over = limit + 1000;
+    uint8_t frame[3];
+    TEST_CHECK(bulk.EncodeMicrovolt(&bulk, &over, 1, frame, NULL).out_volt == 1, "ref %.3f: no out_volt", ref);
+}
+
+static void Test_Bench(dac80501_t* dev)
+{
+    static int32_t uv[TEST_BENCH_LEN];
+    static uint8_t frames[TEST_BENCH_LEN * 3];
+    static uint8_t ranges[TEST_BENCH_LEN];
+    dac80501_bulk_t bulk;
+
+    DAC80501_BULK_API_INIT(&bulk);
+    bulk.Init(&bulk, dev);
+
+    for(int i=0; i<TEST_BENCH_LEN; i++)
+        uv[i] = (int32_t)((int64_t)i * 4999999 / TEST_BENCH_LEN);
+
+    uint64_t n = (uint64_t)TEST_BENCH_LEN * TEST_BENCH_REP;
+
+    uint64_t t0 = Dac80501_TestNanos();
+    for(int r=0; r<TEST_BENCH_REP; r++)
+        for(int i=0; i<TEST_BENCH_LEN; i++)
+            dev->SetDacOut(dev, Test_Volt(uv[i]));
+    uint64_t t1 = Dac80501_TestNanos();
+    for(int r=0; r<TEST_BENCH_REP; r++)
+        bulk.EncodeMicrovolt(&bulk, uv, TEST_BENCH_LEN, frames, ranges);
+    uint64_t t2 = Dac80501_TestNanos();
+
+    double scalar = n * 1e9 / (t1 - t0);
+    double integer = n * 1e9 / (t2 - t1);
+
+    printf("bench: SetDacOut %.1f Msamples/s, EncodeMicrovolt %.1f Msamples/s (%.1fx)", scalar / 1e6, integer / 1e6, integer / scalar);
+
+#if DAC80501_MATH == DAC80501_MATH_DOUBLE
+    static double v[TEST_BENCH_LEN];
+    for(int i=0; i<TEST_BENCH_LEN; i++)
+        v[i] = uv[i] / 1e6;
+
+    uint64_t t3 = Dac80501_TestNanos();
+    for(int r=0; r<TEST_BENCH_REP; r++)
+        bulk.EncodeDouble(&bulk, v, TEST_BENCH_LEN, frames, ranges);
+    uint64_t t4 = Dac80501_TestNanos();
+
+    double simd = n * 1e9 / (t4 - t3);
+    printf(", EncodeDouble %.1f Msamples/s (%.1fx)", simd / 1e6, simd / scalar);
+#endif
+
+    printf("\n");
+}
+
+int main(void)
+{
+    const double refs[] = {DAC80501_INTERNAL_VREF, 4.096, 3.3, 1.8};
+    DAC80501_Transport transport = {NULL, Test_Record};
+    dac80501_t dev;
+
+    DAC80501_SPI_API_INIT(&dev);
+    dev.InitTransport(&dev, &transport, DAC80501_VOLT(0), NULL);
+
+    for(int i=0; i<4; i++)
+    {
+        if(i)
+            dev.SetRefVolt(&dev, DAC80501_VOLT(refs[i]));
+
+        Test_Parity(&dev, refs[i]);
+    }
+
+    dev.SetRefPower(&dev, 0);
+    Test_Bench(&dev);
+
+    dev.DeInit(&dev, NULL);
+
+    return TEST_REPORT("bulk");
+}
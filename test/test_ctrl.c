@@ -0,0 +1,330 @@
+/*
+@filename   test_ctrl.c
+
+@brief		控制环执行模块测试：以一阶对象模型检查PID的稳态误差和调节时间，逐帧检查量程切换时的输出，
+            检查用户控制核的替换、更换控制核时被中断的输出、量程回差、DAC数据未改变时不占用总线，并报告Step的单次耗时
+
+@time		2026/10/18
+
+@author		丁鹏龙
+*/
+#include "dac80501_test.h"
+#include "dac80501_ctrl.h"
+
+#include <math.h>
+
+#define TEST_STEPS          400     //每次调节运行的采样周期数
+#define TEST_TAU_SHIFT      3       //对象时间常数为2^TEST_TAU_SHIFT个采样周期
+#define TEST_BENCH_LOOPS    1000000
+
+//电压换算为相对两倍基准电压的Q24输出
+#define TEST_Q24(ref, v) ((int32_t)((v) / (2 * (ref)) * (1 << 24) + 0.5))
+
+//由V/V增益换算为Q16的PID增益，测量值单位为uV
+#define TEST_GAIN(ref, g) ((int32_t)((g) * (1 << 24) / (2 * (ref) * 1e6) * (1 << DAC80501_CTRL_GAIN_Q) + 0.5))
+
+typedef struct
+{
+    uint32_t frames;        //调节过程中的数据帧数
+    uint32_t quiet;         //稳态最后100个周期的数据帧数
+    double   span;          //稳态最后100个周期DAC输出的变化范围，单位V
+    int      settle;        //进入并保持在1mV误差带内所需的周期数，为-1时表示未进入
+    double   error;         //最终误差，单位V
+    uint8_t  switches;      //量程切换次数
+}test_run_t;
+
+/*
+    一阶对象：输出以时间常数2^TEST_TAU_SHIFT个采样周期跟随DAC输出，测量值单位为uV
+    每个周期逐帧检查Step写入时的中间输出不超过写入前后输出中的较大值
+*/
+static void Test_Run(dac80501_probe_t* probe, dac80501_ctrl_t* ctrl, int32_t* plant, double setpoint, test_run_t* run)
+{
+    uint8_t range, range_last;
+    ctrl->dev->GetDacRange(ctrl->dev, &range_last);
+
+    ctrl->SetSetpoint(ctrl, (int32_t)(setpoint * 1e6));
+
+    run->frames = 0;
+    run->quiet = 0;
+    run->settle = -1;
+    run->switches = 0;
+
+    double low = 1e9, high = -1e9;
+
+    for(int i=0; i<TEST_STEPS; i++)
+    {
+        double before = Dac80501_ProbeVout(probe);
+
+        Dac80501_ProbeClear(probe);
+        TEST_CHECK(ctrl->Step(ctrl, *plant).data == 0, "step %d", i);
+
+        double after = Dac80501_ProbeVout(probe);
+        double hi = ((before > after) ? before : after) + TEST_LSB(2.5, DAC80501_RANGE_DOUBLE);
+
+        TEST_CHECK((probe->frames == 0) || (probe->vout_max <= hi), "%.3f V step %d: %.6f -> %.6f, peak %.6f",
+            setpoint, i, before, after, probe->vout_max);
+
+        run->frames += probe->frames;
+        if(i >= TEST_STEPS - 100)
+        {
+            run->quiet += probe->frames;
+            low = (after < low) ? after : low;
+            high = (after > high) ? after : high;
+        }
+
+        ctrl->dev->GetDacRange(ctrl->dev, &range);
+        run->switches += (range != range_last);
+        range_last = range;
+
+        *plant += ((int32_t)(after * 1e6) - *plant) >> TEST_TAU_SHIFT;
+
+        if(fabs(*plant / 1e6 - setpoint) > 1e-3)
+            run->settle = -1;
+        else if(run->settle < 0)
+            run->settle = i + 1;
+    }
+
+    run->error = *plant / 1e6 - setpoint;
+    run->span = high - low;
+
+    printf("pid %.3f V: settled in %d steps, error %.1f uV, %u frames, %u range switches, "
+        "%u frames and %.1f uV output span in the last 100 steps\n",
+        setpoint, run->settle, run->error * 1e6, run->frames, run->switches, run->quiet, run->span * 1e6);
+}
+
+static void Test_Pid(dac80501_probe_t* probe, dac80501_t* dev)
+{
+    dac80501_ctrl_t ctrl;
+    test_run_t run;
+    int32_t plant = 0;
+
+    DAC80501_CTRL_API_INIT(&ctrl);
+    TEST_CHECK(ctrl.Init(&ctrl, dev).data == 0, "ctrl init");
+    ctrl.SetGains(&ctrl, TEST_GAIN(2.5, 0.5), TEST_GAIN(2.5, 0.05), 0);
+
+    //0V升至4V，降至1V，再升至2.2V，每次都跨越量程；积分项使稳态误差在1LSB以内
+    //设定值一般不是DAC数据的整数倍，稳态时输出在相邻两个DAC数据之间切换
+    const double setpoints[] = {4.0, 1.0, 2.2};
+
+    for(int k=0; k<3; k++)
+    {
+        double sp = setpoints[k];
+        uint8_t range;
+
+        Test_Run(probe, &ctrl, &plant, sp, &run);
+        dev->GetDacRange(dev, &range);
+
+        TEST_CHECK((run.settle > 0) && (run.settle < TEST_STEPS - 100), "%.3f V not settled", sp);
+        TEST_CHECK(fabs(run.error) <= TEST_LSB(2.5, range) + 1e-6, "%.3f V error %.1f uV", sp, run.error * 1e6);
+        TEST_CHECK(run.span <= TEST_LSB(2.5, range) + 1e-9, "%.3f V: output span %.1f uV at steady state", sp, run.span * 1e6);
+
+        //误差为0时输出不变，不占用总线
+        Dac80501_ProbeClear(probe);
+        for(int i=0; i<10; i++)
+            ctrl.Step(&ctrl, (int32_t)(sp * 1e6));
+        TEST_CHECK(probe->frames <= 1, "%.3f V: %u frames with zero error", sp, probe->frames);
+    }
+}
+
+//返回私有数据中的固定输出
+static int32_t Test_Constant(dac80501_ctrl_t* ctrl, const int32_t measure)
+{
+    (void)measure;
+
+    return *(const int32_t*)ctrl->user;
+}
+
+//以用户控制核直接给出输出，检查任意两个电压之间切换的中间输出和量程回差
+static void Test_Kernel(dac80501_probe_t* probe, dac80501_t* dev)
+{
+    dac80501_ctrl_t ctrl;
+    int32_t q = 0;
+
+    DAC80501_CTRL_API_INIT(&ctrl);
+    ctrl.Init(&ctrl, dev);
+    ctrl.SetKernel(&ctrl, Test_Constant, &q);
+
+    const double levels[] = {0.2, 0.6, 1.0, 1.2, 1.3, 2.0, 2.4, 2.6, 3.7, 4.9};
+    double overshoot = 0;
+
+    for(int i=0; i<10; i++)
+        for(int j=0; j<10; j++)
+        {
+            if(i == j)
+                continue;
+
+            q = TEST_Q24(2.5, levels[i]);
+            ctrl.Step(&ctrl, 0);
+
+            Dac80501_ProbeClear(probe);
+            q = TEST_Q24(2.5, levels[j]);
+            ctrl.Step(&ctrl, 0);
+
+            double hi = (levels[i] > levels[j]) ? levels[i] : levels[j];
+            double vout = Dac80501_ProbeVout(probe);
+
+            TEST_CHECK(fabs(vout - levels[j]) <= TEST_LSB(2.5, DAC80501_RANGE_DOUBLE), "%.3f->%.3f: end %.6f",
+                levels[i], levels[j], vout);
+            TEST_CHECK(probe->vout_max <= hi + TEST_LSB(2.5, DAC80501_RANGE_DOUBLE), "%.3f->%.3f: peak %.6f",
+                levels[i], levels[j], probe->vout_max);
+
+            if(probe->vout_max - hi > overshoot)
+                overshoot = probe->vout_max - hi;
+
+            //输出未改变时不占用总线
+            Dac80501_ProbeClear(probe);
+            ctrl.Step(&ctrl, 12345);
+            TEST_CHECK(probe->frames == 0, "%.3f: %u frames for unchanged output", levels[j], probe->frames);
+        }
+
+    printf("kernel: 90 transitions, max %.3f uV above the larger end\n", overshoot * 1e6);
+
+    //量程回差：1.3V在UNITY量程，降至1.2V仍高于HALF量程满量程的15/16，降至1.1V才切换
+    uint8_t range;
+    q = TEST_Q24(2.5, 1.3);
+    ctrl.Step(&ctrl, 0);
+    q = TEST_Q24(2.5, 1.2);
+    ctrl.Step(&ctrl, 0);
+    dev->GetDacRange(dev, &range);
+    TEST_CHECK(range == DAC80501_RANGE_UNITY, "1.2V after 1.3V in range %u", range);
+
+    q = TEST_Q24(2.5, 1.1);
+    ctrl.Step(&ctrl, 0);
+    dev->GetDacRange(dev, &range);
+    TEST_CHECK(range == DAC80501_RANGE_HALF, "1.1V after 1.2V in range %u", range);
+
+    //超出输出范围时由Step限幅
+    q = -1000;
+    ctrl.Step(&ctrl, 0);
+    TEST_CHECK(Dac80501_ProbeVout(probe) == 0, "negative output %.6f", Dac80501_ProbeVout(probe));
+    q = 1 << 25;
+    ctrl.Step(&ctrl, 0);
+    TEST_CHECK(Dac80501_ProbeVout(probe) >= 5.0 - TEST_LSB(2.5, DAC80501_RANGE_DOUBLE), "clamped output %.6f", Dac80501_ProbeVout(probe));
+
+    //恢复PID：增益为0且积分项已清零时输出为0V
+    ctrl.SetKernel(&ctrl, NULL, NULL);
+    ctrl.Reset(&ctrl);
+    ctrl.Step(&ctrl, 0);
+    TEST_CHECK(Dac80501_ProbeVout(probe) == 0, "pid restored: %.6f", Dac80501_ProbeVout(probe));
+}
+
+//在SetKernel的写入与发布之间执行的Step
+typedef struct
+{
+    dac80501_ctrl_t*    ctrl;
+    dac80501_probe_t*   probe;
+    uint32_t            calls;      //模拟中断的次数
+    double              vout;       //中断中Step之后的输出电压
+}test_swap_t;
+
+static void Test_SwapIsr(void* arg)
+{
+    test_swap_t* swap = (test_swap_t*)arg;
+
+    swap->ctrl->Step(swap->ctrl, 0);
+    swap->vout = Dac80501_ProbeVout(swap->probe);
+    swap->calls++;
+}
+
+//更换控制核时被Step中断，中断仍以旧的控制核和私有数据运算，不会以PID或不配套的私有数据输出
+static void Test_Swap(dac80501_probe_t* probe, dac80501_t* dev)
+{
+    dac80501_ctrl_t ctrl;
+    int32_t a = TEST_Q24(2.5, 3.0), b = TEST_Q24(2.5, 1.0);
+    test_swap_t swap = {&ctrl, probe, 0, 0};
+
+    DAC80501_CTRL_API_INIT(&ctrl);
+    ctrl.Init(&ctrl, dev);
+    ctrl.SetKernel(&ctrl, Test_Constant, &a);
+    ctrl.Step(&ctrl, 0);
+
+    //控制核不变，只更换私有数据
+    Dac80501_TestSetPreempt(Test_SwapIsr, &swap);
+    ctrl.SetKernel(&ctrl, Test_Constant, &b);
+    Dac80501_TestSetPreempt(NULL, NULL);
+
+    TEST_CHECK(swap.calls == 1, "swap: %u preemptions", swap.calls);
+    TEST_CHECK(fabs(swap.vout - 3.0) <= TEST_LSB(2.5, DAC80501_RANGE_DOUBLE), "swap user: preempted step %.6f", swap.vout);
+
+    ctrl.Step(&ctrl, 0);
+    TEST_CHECK(fabs(Dac80501_ProbeVout(probe) - 1.0) <= TEST_LSB(2.5, DAC80501_RANGE_DOUBLE), "swap user: after %.6f",
+        Dac80501_ProbeVout(probe));
+
+    //恢复PID，中断仍使用旧的控制核
+    Dac80501_TestSetPreempt(Test_SwapIsr, &swap);
+    ctrl.SetKernel(&ctrl, NULL, NULL);
+    Dac80501_TestSetPreempt(NULL, NULL);
+
+    TEST_CHECK(swap.calls == 2, "restore: %u preemptions", swap.calls);
+    TEST_CHECK(fabs(swap.vout - 1.0) <= TEST_LSB(2.5, DAC80501_RANGE_DOUBLE), "restore pid: preempted step %.6f", swap.vout);
+
+    //再次设置控制核，写入另一个槽
+    Dac80501_TestSetPreempt(Test_SwapIsr, &swap);
+    ctrl.SetKernel(&ctrl, Test_Constant, &a);
+    Dac80501_TestSetPreempt(NULL, NULL);
+
+    TEST_CHECK(swap.vout == 0, "pid: preempted step %.6f", swap.vout);
+    ctrl.Step(&ctrl, 0);
+    TEST_CHECK(fabs(Dac80501_ProbeVout(probe) - 3.0) <= TEST_LSB(2.5, DAC80501_RANGE_DOUBLE), "set again: after %.6f",
+        Dac80501_ProbeVout(probe));
+}
+
+//Step的单次耗时，传输接口只计数，不含芯片模型
+static void Test_Bench(void)
+{
+    uint32_t frames = 0;
+    DAC80501_Transport transport = Dac80501_CountTransport(&frames);
+    dac80501_t dev;
+    dac80501_ctrl_t ctrl;
+
+    DAC80501_SPI_API_INIT(&dev);
+    dev.InitTransport(&dev, &transport, DAC80501_VOLT(0), NULL);
+
+    DAC80501_CTRL_API_INIT(&ctrl);
+    ctrl.Init(&ctrl, &dev);
+    ctrl.SetGains(&ctrl, TEST_GAIN(2.5, 0.5), TEST_GAIN(2.5, 0.05), TEST_GAIN(2.5, 0.1));
+    ctrl.SetSetpoint(&ctrl, 2000000);
+
+    //测量值交替变化，每次都写入DAC数据；测量值不变时只有运算
+    const int32_t measure[2][4] = {{1990000, 2010000, 1995000, 2005000}, {2000000, 2000000, 2000000, 2000000}};
+    const char* name[2] = {"changing", "steady"};
+
+    for(int m=0; m<2; m++)
+    {
+        ctrl.Reset(&ctrl);
+        ctrl.Step(&ctrl, measure[m][0]);
+        ctrl.Step(&ctrl, measure[m][0]);
+        frames = 0;
+
+        uint64_t t0 = Dac80501_TestNanos();
+        uint64_t c0 = TEST_CYCLES();
+        for(int i=0; i<TEST_BENCH_LOOPS; i++)
+            ctrl.Step(&ctrl, measure[m][i & 3]);
+        uint64_t c1 = TEST_CYCLES();
+        uint64_t t1 = Dac80501_TestNanos();
+
+        printf("bench %-8s: Step %.1f ns, %.0f TSC cycles, %.2f frames per call\n", name[m],
+            (double)(t1 - t0) / TEST_BENCH_LOOPS, (double)(c1 - c0) / TEST_BENCH_LOOPS, (double)frames / TEST_BENCH_LOOPS);
+    }
+
+    dev.DeInit(&dev, NULL);
+}
+
+int main(void)
+{
+    dac80501_probe_t probe;
+    dac80501_t dev;
+
+    Dac80501_ProbeInit(&probe, 0);
+    Dac80501_ProbeOpen(&probe, &dev, DAC80501_VOLT(0));
+
+    Test_Pid(&probe, &dev);
+    Test_Kernel(&probe, &dev);
+    Test_Swap(&probe, &dev);
+
+    dev.DeInit(&dev, NULL);
+
+    Test_Bench();
+
+    return TEST_REPORT("ctrl");
+}
@@ -0,0 +1,208 @@
+/*
+@filename   test_dither.c
+
+@brief		抖动模块测试：一阶和二阶整形的平均误差、量化噪声频谱，SetVout换算的小数位精度、切换量程时的输出，以及非法量程的错误类型
+
+@time		2026/10/18
+
+@author		丁鹏龙
+*/
+#include "dac80501_test.h"
+#include "dac80501_dither.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#define TEST_LEN    4096    //每次分析的DAC数据个数
+#define TEST_FRAC   8       //目标值的小数位数
+#define TEST_BAND   64      //低频带为0~fs/(2*TEST_BAND)
+
+/*
+    低频带内的噪声功率占总噪声功率的比例，单位dB
+    白噪声约为-10log10(TEST_BAND)，整形阶数越高越低
+*/
+static double Test_LowBand(const uint16_t* code, double mean)
+{
+    double total = 0, low = 0;
+
+    for(int i=0; i<TEST_LEN; i++)
+        total += (code[i] - mean) * (code[i] - mean);
+
+    //直接计算低频带的DFT，不含直流
+    for(int k=1; k<=TEST_LEN / (2 * TEST_BAND); k++)
+    {
+        double re = 0, im = 0;
+
+        for(int i=0; i<TEST_LEN; i++)
+        {
+            double w = 2 * M_PI * k * i / TEST_LEN;
+            re += (code[i] - mean) * cos(w);
+            im -= (code[i] - mean) * sin(w);
+        }
+
+        low += 2 * (re * re + im * im) / TEST_LEN;
+    }
+
+    return (total > 0) ? 10 * log10(low / total + 1e-30) : -300;
+}
+
+static void Test_Order(dac80501_t* dev, uint8_t order, double* low_db)
+{
+    dac80501_dither_t dither;
+    static uint16_t code[TEST_LEN];
+    const double targets[] = {1000.3, 20000.5, 33333.01, 65000.99};
+
+    DAC80501_DITHER_API_INIT(&dither);
+    TEST_CHECK(dither.Init(&dither, dev, order, TEST_FRAC).data == 0, "init order %u", order);
+
+    double worst_mean = 0, worst_low = -300;
+
+    for(int t=0; t<4; t++)
+    {
+        uint32_t fixed = (uint32_t)(targets[t] * (1 << TEST_FRAC) + 0.5);
+        double target = (double)fixed / (1 << TEST_FRAC);
+        uint16_t filled;
+
+        dither.SetCode(&dither, DAC80501_RANGE_UNITY, fixed);
+
+        //丢弃第一段，使误差进入稳态
+        dither.Fill(&dither, code, TEST_LEN, &filled);
+        dither.Fill(&dither, code, TEST_LEN, &filled);
+        TEST_CHECK(filled == TEST_LEN, "filled %u", filled);
+
+        double sum = 0;
+        for(int i=0; i<TEST_LEN; i++)
+            sum += code[i];
+
+        double mean = sum / TEST_LEN;
+        double err = fabs(mean - target);
+        double low = Test_LowBand(code, mean);
+
+        //误差有界，平均误差不超过2LSB/TEST_LEN
+        TEST_CHECK(err <= 2.0 / TEST_LEN, "order %u target %.4f: mean %.6f", order, target, mean);
+
+        if(err > worst_mean)
+            worst_mean = err;
+        if(low > worst_low)
+            worst_low = low;
+    }
+
+    *low_db = worst_low;
+    printf("order %u: mean error <= %.2e LSB, low-band noise <= %.1f dB of total (white: %.1f dB)\n",
+        order, worst_mean, worst_low, -10 * log10(TEST_BAND));
+}
+
+//以Tick写入芯片，芯片模型的平均输出电压等于目标电压
+static void Test_TickMean(dac80501_probe_t* probe, dac80501_t* dev)
+{
+    dac80501_dither_t dither;
+    const double target = 1.2345678;
+
+    DAC80501_DITHER_API_INIT(&dither);
+    dither.Init(&dither, dev, 2, DAC80501_DITHER_MAX_FRAC);
+    dither.SetVout(&dither, DAC80501_VOLT(target));
+
+    double sum = 0;
+    for(int i=0; i<TEST_LEN * 4; i++)
+    {
+        dither.Tick(&dither);
+        sum += Dac80501_ProbeVout(probe);
+    }
+
+    double mean = sum / (TEST_LEN * 4);
+    double lsb = TEST_LSB(2.5, 0);
+    TEST_CHECK(fabs(mean - target) <= lsb / 64, "tick mean %.9f, target %.9f", mean, target);
+    printf("tick: mean %.9f V for %.9f V, error %.4f LSB\n", mean, target, fabs(mean - target) / lsb);
+}
+
+//Fill切换量程时中间输出不超过起止电压中的较大值
+static void Test_RangeSwitch(dac80501_probe_t* probe, dac80501_t* dev)
+{
+    dac80501_dither_t dither;
+    uint16_t code[16], filled;
+
+    //由HALF量程的1.2V切换到UNITY量程的1.3V，先写GAIN会使旧数据在新量程下输出约2.4V
+    dev->SetDacOut(dev, DAC80501_VOLT(1.2));
+
+    DAC80501_DITHER_API_INIT(&dither);
+    dither.Init(&dither, dev, 1, TEST_FRAC);
+    dither.SetVout(&dither, DAC80501_VOLT(1.3));
+
+    Dac80501_ProbeClear(probe);
+    dither.Fill(&dither, code, 16, &filled);
+    TEST_CHECK(probe->vout_max <= 1.3 + TEST_LSB(2.5, 1), "range switch peak %.6f", probe->vout_max);
+}
+
+//SetVout换算的目标值保留全部小数位，单精度运算时同样与双精度的换算结果一致
+static void Test_SetVoutCode(dac80501_t* dev)
+{
+    dac80501_dither_t dither;
+    const double ref = DAC80501_INTERNAL_VREF;
+    uint32_t worst = 0;
+
+    DAC80501_DITHER_API_INIT(&dither);
+    dither.Init(&dither, dev, 2, DAC80501_DITHER_MAX_FRAC);
+
+    for(int i=1; i<5000; i++)
+    {
+        DAC80501_Volt vout = DAC80501_VOLT(i * 0.000999);
+        double v = (double)vout;
+        uint8_t range = (v > ref / 2) + (v > ref);
+        double full = ref / 2 * (1 << range);
+        int64_t expected = (int64_t)round(v * (double)(1UL << (16 + DAC80501_DITHER_MAX_FRAC)) / full);
+
+        dither.SetVout(&dither, vout);
+        int64_t code = dither.setpoint & ((1UL << 30) - 1);
+        uint32_t diff = (uint32_t)llabs(code - expected);
+
+        if(diff > worst)
+            worst = diff;
+    }
+
+    TEST_CHECK(worst <= 1, "SetVout code differs by %u (1/%u LSB)", worst, 1U << DAC80501_DITHER_MAX_FRAC);
+}
+
+//非法量程返回param错误，不改变已设定的目标值
+static void Test_BadRange(dac80501_t* dev)
+{
+    dac80501_dither_t dither;
+    DAC80501_Error error;
+
+    DAC80501_DITHER_API_INIT(&dither);
+    dither.Init(&dither, dev, 1, TEST_FRAC);
+    dither.SetCode(&dither, DAC80501_RANGE_UNITY, 1000 << TEST_FRAC);
+
+    error = dither.SetCode(&dither, DAC80501_RANGE_DOUBLE + 1, 0);
+    TEST_CHECK((error.param == 1) && (error.gain == 0), "bad range: error %#x", (unsigned)error.data);
+
+    dither.Tick(&dither);
+    uint8_t range;
+    dev->GetDacRange(dev, &range);
+    TEST_CHECK(range == DAC80501_RANGE_UNITY, "bad range changed the setpoint to range %u", range);
+}
+
+int main(void)
+{
+    dac80501_probe_t probe;
+    dac80501_t dev;
+    double low1, low2;
+
+    Dac80501_ProbeInit(&probe, 0);
+    Dac80501_ProbeOpen(&probe, &dev, DAC80501_VOLT(0));
+
+    Test_Order(&dev, 1, &low1);
+    Test_Order(&dev, 2, &low2);
+
+    //整形后低频带噪声低于白噪声，二阶低于一阶
+    TEST_CHECK(low1 < -10 * log10(TEST_BAND) - 10, "order 1 low band %.1f dB", low1);
+    TEST_CHECK(low2 < low1, "order 2 (%.1f dB) not below order 1 (%.1f dB)", low2, low1);
+
+    Test_TickMean(&probe, &dev);
+    Test_RangeSwitch(&probe, &dev);
+    Test_SetVoutCode(&dev);
+    Test_BadRange(&dev);
+
+    dev.DeInit(&dev, NULL);
+
+    return TEST_REPORT("dither");
+}
@@ -0,0 +1,199 @@
+/*
+@filename   test_group.c
+
+@brief		多设备操作测试：以虚拟时钟比较成组与逐个初始化、软重置的耗时，检查每个设备恢复输出只调用一次
+            传输接口，任一设备参数有误时不发送数据，静态存储池不足时释放已绑定的设备
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@attention  同一文件以完整配置和精简配置分别编译运行；精简配置下设备数不超过DAC80501_MAX_DEVICES，
+            另外检查超出存储池容量的一组设备。
+*/
+#include "dac80501_test.h"
+
+#include <math.h>
+#include <string.h>
+
+//完整配置动态申请空间，其他配置使用静态存储池
+#define TEST_POOL (DAC80501_PROFILE != DAC80501_PROFILE_FULL)
+
+#if TEST_POOL
+#define TEST_MAX_N DAC80501_MAX_DEVICES
+#else
+#define TEST_MAX_N 256
+#endif
+
+static dac80501_probe_t probe[TEST_MAX_N + 1];
+static dac80501_t dev[TEST_MAX_N + 1];
+static dac80501_t* devs[TEST_MAX_N + 1];
+static DAC80501_Transport transports[TEST_MAX_N + 1];
+static DAC80501_Volt vout[TEST_MAX_N + 1];
+
+//第i个设备的默认输出电压，避开各量程的满量程
+static double Test_Default(int i)
+{
+    return 0.13 + (i % 48) * 0.1;
+}
+
+//准备n个未初始化的设备及其芯片模型
+static void Test_Prepare(int n)
+{
+    for(int i=0; i<n; i++)
+    {
+        Dac80501_ProbeInit(&probe[i], 0);
+        memset(&dev[i], 0, sizeof(dac80501_t));
+        DAC80501_SPI_API_INIT(&dev[i]);
+        devs[i] = &dev[i];
+        transports[i] = Dac80501_ProbeTransport(&probe[i]);
+        vout[i] = DAC80501_VOLT(Test_Default(i));
+    }
+}
+
+//检查各设备的输出电压和软重置次数，以及复位和恢复输出各只调用一次传输接口，检查后清空探针的记录
+static void Test_Outputs(int n, uint32_t resets, const char* name)
+{
+    for(int i=0; i<n; i++)
+    {
+        double v = Test_Default(i);
+        uint8_t range;
+        dev[i].GetDacRange(&dev[i], &range);
+
+        double out = Dac80501_ProbeVout(&probe[i]);
+        TEST_CHECK(fabs(out - v) <= TEST_LSB(2.5, range), "%s N=%d: vout[%d] %.6f, expected %.3f", name, n, i, out, v);
+        TEST_CHECK(probe[i].sim.resets == resets, "%s N=%d: %u resets on device %d", name, n, probe[i].sim.resets, i);
+        TEST_CHECK(probe[i].writes == 2, "%s N=%d: %u writes on device %d", name, n, probe[i].writes, i);
+
+        Dac80501_ProbeClear(&probe[i]);
+    }
+}
+
+static void Test_DeInit(int n)
+{
+    for(int i=0; i<n; i++)
+        dev[i].DeInit(&dev[i], NULL);
+}
+
+//成组初始化和软重置只等待一次复位完成时间，逐个操作的耗时随设备个数线性增加
+static void Test_Timing(int n)
+{
+    //逐个初始化
+    Test_Prepare(n);
+
+    uint64_t t0 = Dac80501_TestClock();
+    for(int i=0; i<n; i++)
+        TEST_CHECK(dev[i].InitTransport(&dev[i], &transports[i], vout[i], NULL).data == 0, "init %d", i);
+    uint64_t seq = Dac80501_TestClock() - t0;
+
+    Test_Outputs(n, 1, "sequential");
+    Test_DeInit(n);
+
+    //成组初始化
+    Test_Prepare(n);
+
+    t0 = Dac80501_TestClock();
+    TEST_CHECK(DAC80501_GroupInitTransport(devs, transports, vout, n, NULL).data == 0, "group init N=%d", n);
+    uint64_t group = Dac80501_TestClock() - t0;
+
+    Test_Outputs(n, 1, "group init");
+
+    //逐个软重置
+    t0 = Dac80501_TestClock();
+    for(int i=0; i<n; i++)
+        dev[i].SoftReset(&dev[i]);
+    uint64_t seq_reset = Dac80501_TestClock() - t0;
+
+    Test_Outputs(n, 2, "sequential reset");
+
+    //成组软重置
+    t0 = Dac80501_TestClock();
+    TEST_CHECK(DAC80501_GroupSoftReset(devs, n).data == 0, "group reset N=%d", n);
+    uint64_t group_reset = Dac80501_TestClock() - t0;
+
+    Test_Outputs(n, 3, "group reset");
+    Test_DeInit(n);
+
+    printf("N=%3d: init %7llu us sequential, %4llu us group; soft reset %7llu us sequential, %4llu us group\n", n,
+        (unsigned long long)seq, (unsigned long long)group, (unsigned long long)seq_reset, (unsigned long long)group_reset);
+
+    TEST_CHECK(seq == 2000ULL * n, "sequential init N=%d took %llu us", n, (unsigned long long)seq);
+    TEST_CHECK(group == 2000, "group init N=%d took %llu us", n, (unsigned long long)group);
+    TEST_CHECK(seq_reset == 2000ULL * n, "sequential reset N=%d took %llu us", n, (unsigned long long)seq_reset);
+    TEST_CHECK(group_reset == 2000, "group reset N=%d took %llu us", n, (unsigned long long)group_reset);
+}
+
+//检查所有设备都没有收到数据帧，也没有绑定存储空间和传输接口
+static void Test_Unbound(int n, const char* name)
+{
+    uint32_t frames = 0, bound = 0;
+
+    for(int i=0; i<n; i++)
+    {
+        frames += probe[i].frames;
+        bound += (dev[i].option != NULL) || (dev[i].transport.Write != NULL);
+    }
+
+    TEST_CHECK((frames == 0) && (bound == 0), "%s: %u frames, %u devices left bound", name, frames, bound);
+}
+
+//任一设备参数有误时直接返回，不分配空间也不发送数据
+static void Test_BadDevice(void)
+{
+    const int n = (TEST_MAX_N < 16) ? TEST_MAX_N : 16;
+    DAC80501_Error error;
+
+    Test_Prepare(n);
+    vout[n - 1] = DAC80501_VOLT(5.5);
+    error = DAC80501_GroupInitTransport(devs, transports, vout, n, NULL);
+    TEST_CHECK(error.out_volt == 1, "bad vout: error %#x", (unsigned)error.data);
+    Test_Unbound(n, "bad vout");
+
+    Test_Prepare(n);
+    transports[n / 2].Write = NULL;
+    error = DAC80501_GroupInitTransport(devs, transports, vout, n, NULL);
+    TEST_CHECK(error.spi == 1, "bad transport: error %#x", (unsigned)error.data);
+    Test_Unbound(n, "bad transport");
+
+    Test_Prepare(n);
+    devs[n / 2] = NULL;
+    error = DAC80501_GroupInitTransport(devs, transports, vout, n, NULL);
+    TEST_CHECK(error.dev == 1, "null device: error %#x", (unsigned)error.data);
+    Test_Unbound(n, "null device");
+}
+
+#if TEST_POOL
+//一组设备超出存储池容量时返回malloc错误，已绑定的设备全部释放，存储池可供下一组使用
+static void Test_PoolExhausted(void)
+{
+    const int n = TEST_MAX_N + 1;
+    DAC80501_Error error;
+
+    Test_Prepare(n);
+    error = DAC80501_GroupInitTransport(devs, transports, vout, n, NULL);
+    TEST_CHECK(error.malloc == 1, "pool exhausted: error %#x", (unsigned)error.data);
+    Test_Unbound(n, "pool exhausted");
+
+    Test_Prepare(TEST_MAX_N);
+    TEST_CHECK(DAC80501_GroupInitTransport(devs, transports, vout, TEST_MAX_N, NULL).data == 0, "pool reuse");
+    Test_Outputs(TEST_MAX_N, 1, "pool reuse");
+    Test_DeInit(TEST_MAX_N);
+}
+#endif
+
+int main(void)
+{
+    const int sizes[] = {1, 16, TEST_MAX_N};
+
+    for(int k=0; k<3; k++)
+        if((k == 0) || (sizes[k] > sizes[k - 1]))
+            Test_Timing(sizes[k]);
+
+    Test_BadDevice();
+
+#if TEST_POOL
+    Test_PoolExhausted();
+#endif
+
+    return TEST_REPORT(TEST_POOL ? "group_pool" : "group");
+}
@@ -0,0 +1,213 @@
+/*
+@filename   test_interp.c
+
+@brief		插值模块测试：Tick与Fill输出到达设定点，Fill在段首切换量程且不越过段终点，
+            并比较Tick、Fill与SetDacOut每个输出点的耗时
+
+@time		2026/10/18
+
+@author		丁鹏龙
+*/
+#include "dac80501_test.h"
+#include "dac80501_interp.h"
+
+#include <math.h>
+
+#define TEST_BENCH_RATIO    50      //上采样倍数
+#define TEST_BENCH_SEGS     20000   //设定点个数
+
+//把Fill生成的数据逐个写入芯片，模拟DMA发送
+static void Test_Send(dac80501_t* dev, const uint16_t* buf, uint16_t n)
+{
+    for(uint16_t i=0; i<n; i++)
+        dev->SetDacCode(dev, buf[i]);
+}
+
+//Tick：线性插值逐点到达设定点，停在终点后不再占用总线
+static void Test_TickLinear(void)
+{
+    dac80501_probe_t probe;
+    dac80501_t dev;
+    dac80501_interp_t interp;
+
+    Dac80501_ProbeInit(&probe, 0);
+    TEST_CHECK(Dac80501_ProbeOpen(&probe, &dev, DAC80501_VOLT(0.5)).data == 0, "init");
+
+    DAC80501_INTERP_API_INIT(&interp);
+    TEST_CHECK(interp.Init(&interp, &dev, DAC80501_INTERP_LINEAR, 4).data == 0, "interp init");
+
+    interp.Push(&interp, DAC80501_VOLT(0.5));
+    interp.Push(&interp, DAC80501_VOLT(1.0));
+
+    double last = Dac80501_ProbeVout(&probe);
+    for(int i=0; i<16; i++)
+    {
+        TEST_CHECK(interp.Tick(&interp).data == 0, "tick %d", i);
+
+        double vout = Dac80501_ProbeVout(&probe);
+        TEST_CHECK(vout >= last - 1e-9, "tick %d not monotonic: %.6f -> %.6f", i, last, vout);
+        last = vout;
+    }
+
+    TEST_CHECK(fabs(last - 1.0) <= TEST_LSB(2.5, 0), "linear end %.6f", last);
+
+    Dac80501_ProbeClear(&probe);
+    for(int i=0; i<8; i++)
+        interp.Tick(&interp);
+    TEST_CHECK(probe.frames == 0, "hold wrote %u frames", probe.frames);
+
+    dev.DeInit(&dev, NULL);
+}
+
+//Tick：三次插值经过每个设定点
+static void Test_TickCubic(void)
+{
+    dac80501_probe_t probe;
+    dac80501_t dev;
+    dac80501_interp_t interp;
+    const double points[] = {1.0, 1.5, 2.0, 1.8, 1.8};
+
+    Dac80501_ProbeInit(&probe, 0);
+    Dac80501_ProbeOpen(&probe, &dev, DAC80501_VOLT(1.0));
+
+    DAC80501_INTERP_API_INIT(&interp);
+    interp.Init(&interp, &dev, DAC80501_INTERP_CUBIC, 8);
+
+    for(int i=0; i<5; i++)
+        interp.Push(&interp, DAC80501_VOLT(points[i]));
+
+    //三次插值延迟两个设定周期，每段结束时输出为该段终点
+    for(int seg=0; seg<6; seg++)
+        for(int i=0; i<8; i++)
+            interp.Tick(&interp);
+
+    double vout = Dac80501_ProbeVout(&probe);
+    TEST_CHECK(fabs(vout - 1.8) <= TEST_LSB(2.5, 1), "cubic end %.6f", vout);
+    TEST_CHECK(probe.vout_max <= 2.0 + 0.05, "cubic overshoot %.6f", probe.vout_max);
+
+    dev.DeInit(&dev, NULL);
+}
+
+//Fill：跨量程的阶跃，在段首以SetDacRangeCode切换量程，输出不回绕也不超过终点
+static void Test_FillRangeSwitch(void)
+{
+    dac80501_probe_t probe;
+    dac80501_t dev;
+    dac80501_interp_t interp;
+    uint16_t buf[6], n;
+
+    Dac80501_ProbeInit(&probe, 0);
+    Dac80501_ProbeOpen(&probe, &dev, DAC80501_VOLT(1.2));
+
+    DAC80501_INTERP_API_INIT(&interp);
+    interp.Init(&interp, &dev, DAC80501_INTERP_LINEAR, 4);
+
+    //第二段结束时缓冲区中已有数据，切换量程须留待下一次调用
+    interp.Push(&interp, DAC80501_VOLT(1.2));
+    interp.Push(&interp, DAC80501_VOLT(1.0));
+    interp.Push(&interp, DAC80501_VOLT(4.9));
+
+    int32_t last = -1;
+    for(int call=0; call<8; call++)
+    {
+        TEST_CHECK(interp.Fill(&interp, buf, 6, &n).data == 0, "fill %d", call);
+
+        uint8_t range;
+        dev.GetDacRange(&dev, &range);
+
+        //同一量程内的数据单调不减，最后一段保持在终点
+        for(uint16_t i=0; i<n; i++)
+        {
+            TEST_CHECK((range != DAC80501_RANGE_DOUBLE) || (last < 0) || (buf[i] >= last),
+                "fill %d wraps: %04x after %04x", call, buf[i], (unsigned)last);
+
+            if(range == DAC80501_RANGE_DOUBLE)
+                last = buf[i];
+        }
+
+        Test_Send(&dev, buf, n);
+    }
+
+    double vout = Dac80501_ProbeVout(&probe);
+    TEST_CHECK(fabs(vout - 4.9) <= TEST_LSB(2.5, 2), "fill end %.6f", vout);
+    TEST_CHECK(probe.vout_max <= 4.9 + TEST_LSB(2.5, 2), "fill peak %.6f", probe.vout_max);
+    TEST_CHECK(interp.remain == 0, "remain %u after hold", interp.remain);
+
+    dev.DeInit(&dev, NULL);
+}
+
+/*
+    每个输出点的耗时：设定点为UNITY量程内的正弦，每TEST_BENCH_RATIO个输出点Push一次
+    Tick与SetDacOut经过芯片模型的传输接口，Fill只生成数据
+*/
+static void Test_Bench(void)
+{
+    static DAC80501_Volt level[TEST_BENCH_SEGS];
+    static uint16_t buf[TEST_BENCH_RATIO];
+    dac80501_sim_t sim;
+    dac80501_t dev;
+    DAC80501_Transport transport;
+    dac80501_interp_t interp;
+    uint16_t n;
+
+    for(int i=0; i<TEST_BENCH_SEGS; i++)
+        level[i] = DAC80501_VOLT(1.8 + 0.5 * sin(i * 0.01));
+
+    DAC80501_SIM_API_INIT(&sim);
+    sim.Init(&sim, 0);
+    sim.GetTransport(&sim, &transport);
+
+    DAC80501_SPI_API_INIT(&dev);
+    dev.InitTransport(&dev, &transport, level[0], NULL);
+
+    uint64_t n_out = (uint64_t)TEST_BENCH_SEGS * TEST_BENCH_RATIO;
+
+    uint64_t t0 = Dac80501_TestNanos();
+    for(int i=0; i<TEST_BENCH_SEGS; i++)
+        for(int k=0; k<TEST_BENCH_RATIO; k++)
+            dev.SetDacOut(&dev, level[i]);
+    double set_ns = (double)(Dac80501_TestNanos() - t0) / n_out;
+
+    printf("bench: SetDacOut %.1f ns per output", set_ns);
+
+    for(uint8_t mode=DAC80501_INTERP_LINEAR; mode<=DAC80501_INTERP_CUBIC; mode++)
+    {
+        DAC80501_INTERP_API_INIT(&interp);
+        interp.Init(&interp, &dev, mode, TEST_BENCH_RATIO);
+
+        t0 = Dac80501_TestNanos();
+        for(int i=0; i<TEST_BENCH_SEGS; i++)
+        {
+            interp.Push(&interp, level[i]);
+            for(int k=0; k<TEST_BENCH_RATIO; k++)
+                interp.Tick(&interp);
+        }
+        double tick_ns = (double)(Dac80501_TestNanos() - t0) / n_out;
+
+        interp.Reset(&interp);
+
+        t0 = Dac80501_TestNanos();
+        for(int i=0; i<TEST_BENCH_SEGS; i++)
+        {
+            interp.Push(&interp, level[i]);
+            interp.Fill(&interp, buf, TEST_BENCH_RATIO, &n);
+        }
+        double fill_ns = (double)(Dac80501_TestNanos() - t0) / n_out;
+
+        printf(", %s Tick %.1f ns, Fill %.1f ns", (mode == DAC80501_INTERP_CUBIC) ? "cubic" : "linear", tick_ns, fill_ns);
+    }
+
+    printf(" (ratio %d, Push included)\n", TEST_BENCH_RATIO);
+
+    dev.DeInit(&dev, NULL);
+}
+
+int main(void)
+{
+    Test_TickLinear();
+    Test_TickCubic();
+    Test_FillRangeSwitch();
+    Test_Bench();
+
+    return TEST_REPORT("interp");
+}
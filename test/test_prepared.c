@@ -0,0 +1,175 @@
+/*
+@filename   test_prepared.c
+
+@brief		预编码接口测试：输出与SetDacOut一致、基准电压改变后自动重新编码、拒绝其他设备的句柄，并比较两者的单次耗时
+
+@time		2026/10/18
+
+@author		丁鹏龙
+*/
+#include "dac80501_test.h"
+
+#include <math.h>
+#include <string.h>
+
+#define TEST_BENCH_LOOPS 1000000
+
+//ApplyPrepared与SetDacOut得到相同的寄存器
+static void Test_Match(void)
+{
+    dac80501_sim_t sim;
+    dac80501_t dev;
+    DAC80501_Transport transport;
+    DAC80501_Prepared prepared;
+
+    DAC80501_SIM_API_INIT(&sim);
+    sim.Init(&sim, 0);
+    sim.GetTransport(&sim, &transport);
+
+    DAC80501_SPI_API_INIT(&dev);
+    dev.InitTransport(&dev, &transport, DAC80501_VOLT(0), NULL);
+
+    for(int i=0; i<=500; i++)
+    {
+        double v = i * 0.01;
+
+        dev.SetDacOut(&dev, DAC80501_VOLT(v));
+        uint16_t gain = sim.gain, dac = sim.dac_active;
+
+        dev.SetDacOut(&dev, DAC80501_VOLT(5.0 - v));
+        TEST_CHECK(dev.PrepareDacOut(&dev, &prepared, DAC80501_VOLT(v)).data == 0, "prepare %.2f", v);
+        TEST_CHECK(dev.ApplyPrepared(&dev, &prepared).data == 0, "apply %.2f", v);
+        TEST_CHECK((sim.gain == gain) && (sim.dac_active == dac), "%.2f: gain %04x dac %04x, expected %04x %04x",
+            v, sim.gain, sim.dac_active, gain, dac);
+    }
+
+    //量程未改变时只发送DAC数据帧
+    dev.SetDacOut(&dev, DAC80501_VOLT(2.0));
+    dev.PrepareDacOut(&dev, &prepared, DAC80501_VOLT(2.2));
+    sim.ClearStats(&sim);
+    dev.ApplyPrepared(&dev, &prepared);
+    TEST_CHECK(sim.frames == 1, "same range sent %u frames", sim.frames);
+
+    dev.DeInit(&dev, NULL);
+}
+
+//基准电压改变后句柄自动重新编码，包括设备重新初始化后的旧句柄
+static void Test_Stale(void)
+{
+    dac80501_sim_t sim;
+    dac80501_t dev;
+    DAC80501_Transport transport;
+    DAC80501_Prepared prepared;
+    double vout;
+
+    DAC80501_SIM_API_INIT(&sim);
+    sim.Init(&sim, 3.0);
+    sim.GetTransport(&sim, &transport);
+
+    DAC80501_SPI_API_INIT(&dev);
+    dev.InitTransport(&dev, &transport, DAC80501_VOLT(0), NULL);
+    dev.SetRefVolt(&dev, DAC80501_VOLT(3.0));
+    dev.PrepareDacOut(&dev, &prepared, DAC80501_VOLT(2.0));
+
+    dev.SetRefVolt(&dev, DAC80501_VOLT(2.5));
+    dev.SetRefPower(&dev, 0);
+    dev.ApplyPrepared(&dev, &prepared);
+    sim.GetVout(&sim, &vout);
+    TEST_CHECK(fabs(vout - 2.0) <= TEST_LSB(2.5, 1), "after SetRefPower %.6f", vout);
+
+    //重新初始化后基准电压版本不会回到预编码时的值
+    dev.DeInit(&dev, NULL);
+    sim.Init(&sim, 4.0);
+    dev.InitTransport(&dev, &transport, DAC80501_VOLT(0), NULL);
+    dev.SetRefVolt(&dev, DAC80501_VOLT(4.0));
+    dev.ApplyPrepared(&dev, &prepared);
+    sim.GetVout(&sim, &vout);
+    TEST_CHECK(fabs(vout - 2.0) <= TEST_LSB(4.0, 1), "after re-init %.6f", vout);
+
+    dev.DeInit(&dev, NULL);
+}
+
+//其他设备的句柄返回param错误，不重新编码也不发送数据
+static void Test_Foreign(void)
+{
+    dac80501_sim_t sim[2];
+    dac80501_t dev[2];
+    DAC80501_Transport transport[2];
+    DAC80501_Prepared prepared;
+    DAC80501_Error error;
+
+    for(int i=0; i<2; i++)
+    {
+        DAC80501_SIM_API_INIT(&sim[i]);
+        sim[i].Init(&sim[i], 0);
+        sim[i].GetTransport(&sim[i], &transport[i]);
+
+        DAC80501_SPI_API_INIT(&dev[i]);
+        dev[i].InitTransport(&dev[i], &transport[i], DAC80501_VOLT(1.0), NULL);
+    }
+
+    dev[0].PrepareDacOut(&dev[0], &prepared, DAC80501_VOLT(3.0));
+    uint8_t frames[9];
+    uint32_t ref_gen = prepared.ref_gen;
+    memcpy(frames, prepared.frames, sizeof(frames));
+
+    sim[1].ClearStats(&sim[1]);
+    error = dev[1].ApplyPrepared(&dev[1], &prepared);
+    TEST_CHECK(error.param == 1, "foreign handle: error %#x", (unsigned)error.data);
+    TEST_CHECK(sim[1].frames == 0, "foreign handle sent %u frames", sim[1].frames);
+    TEST_CHECK((prepared.dev == &dev[0]) && (prepared.ref_gen == ref_gen) &&
+        (memcmp(frames, prepared.frames, sizeof(frames)) == 0), "foreign handle was re-encoded");
+
+    double vout;
+    sim[1].GetVout(&sim[1], &vout);
+    TEST_CHECK(fabs(vout - 1.0) <= TEST_LSB(2.5, 1), "foreign handle changed vout to %.6f", vout);
+
+    for(int i=0; i<2; i++)
+        dev[i].DeInit(&dev[i], NULL);
+}
+
+//在几个电压之间切换，比较两种接口的单次耗时
+static void Test_Bench(void)
+{
+    dac80501_sim_t sim;
+    dac80501_t dev;
+    DAC80501_Transport transport;
+    DAC80501_Prepared prepared[4];
+    const double level[4] = {0.3, 1.1, 2.4, 4.7};
+
+    DAC80501_SIM_API_INIT(&sim);
+    sim.Init(&sim, 0);
+    sim.GetTransport(&sim, &transport);
+
+    DAC80501_SPI_API_INIT(&dev);
+    dev.InitTransport(&dev, &transport, DAC80501_VOLT(0), NULL);
+
+    for(int i=0; i<4; i++)
+        dev.PrepareDacOut(&dev, &prepared[i], DAC80501_VOLT(level[i]));
+
+    uint64_t t0 = Dac80501_TestNanos();
+    for(int i=0; i<TEST_BENCH_LOOPS; i++)
+        dev.SetDacOut(&dev, DAC80501_VOLT(level[i & 3]));
+    uint64_t t1 = Dac80501_TestNanos();
+    for(int i=0; i<TEST_BENCH_LOOPS; i++)
+        dev.ApplyPrepared(&dev, &prepared[i & 3]);
+    uint64_t t2 = Dac80501_TestNanos();
+
+    double set_ns = (double)(t1 - t0) / TEST_BENCH_LOOPS;
+    double apply_ns = (double)(t2 - t1) / TEST_BENCH_LOOPS;
+
+    printf("bench: SetDacOut %.1f ns, ApplyPrepared %.1f ns (%.2fx), including sim transport\n",
+        set_ns, apply_ns, set_ns / apply_ns);
+
+    dev.DeInit(&dev, NULL);
+}
+
+int main(void)
+{
+    Test_Match();
+    Test_Stale();
+    Test_Foreign();
+    Test_Bench();
+
+    return TEST_REPORT("prepared");
+}
@@ -0,0 +1,163 @@
+/*
+@filename   test_profile.c
+
+@brief		功能裁剪配置测试：同一组功能测试分别以完整、精简和最小配置编译运行，并报告SetDacOut的单次耗时
+
+@time		2026/10/18
+
+@author		丁鹏龙
+
+@attention  只使用所有配置都提供的接口；精简和最小配置使用静态存储池，dac80501_spi_conf.h中的
+            DAC80501_MAX_DEVICES须不小于TEST_GROUP。
+*/
+#include "dac80501_test.h"
+
+#include <math.h>
+
+#define TEST_GROUP          4
+#define TEST_BENCH_LOOPS    1000000
+
+static const char* Test_ProfileName(void)
+{
+#if DAC80501_PROFILE == DAC80501_PROFILE_FULL
+    return "full";
+#elif DAC80501_PROFILE == DAC80501_PROFILE_SMALL
+    return "small";
+#else
+    return "minimal";
+#endif
+}
+
+//检查输出电压，满量程限幅时允许1LSB，单精度运算在舍入边界附近另有少量误差
+static void Test_Vout(dac80501_probe_t* probe, dac80501_t* dev, double ref, double v)
+{
+    uint8_t range;
+    dev->GetDacRange(dev, &range);
+
+    double lsb = TEST_LSB(ref, range);
+    double fs = ref * (1 << range) / 2;
+    double limit = (v > fs - lsb / 2) ? 1.0 : 0.5;
+    double vout = Dac80501_ProbeVout(probe);
+
+#if DAC80501_MATH == DAC80501_MATH_FLOAT
+    limit += 0.01;
+#endif
+
+    TEST_CHECK(fabs(vout - v) <= limit * lsb + 1e-9, "ref %.3f: set %.4f, got %.6f (%.3f LSB)", ref, v, vout, fabs(vout - v) / lsb);
+}
+
+static void Test_Functional(void)
+{
+    dac80501_probe_t probe;
+    dac80501_t dev;
+
+    Dac80501_ProbeInit(&probe, 4.096);
+    TEST_CHECK(Dac80501_ProbeOpen(&probe, &dev, DAC80501_VOLT(1.0)).data == 0, "init");
+    Test_Vout(&probe, &dev, 2.5, 1.0);
+
+    //全范围设置输出
+    for(int i=0; i<=500; i++)
+    {
+        TEST_CHECK(dev.SetDacOut(&dev, DAC80501_VOLT(i * 0.01)).data == 0, "SetDacOut %.2f", i * 0.01);
+        Test_Vout(&probe, &dev, 2.5, i * 0.01);
+    }
+
+    //超出范围的电压
+    TEST_CHECK(dev.SetDacOut(&dev, DAC80501_VOLT(-0.1)).out_volt == 1, "negative vout accepted");
+    TEST_CHECK(dev.SetDacOut(&dev, DAC80501_VOLT(5.1)).out_volt == 1, "5.1V accepted with 2.5V ref");
+
+    //软重置后输出保持不变
+    dev.SetDacOut(&dev, DAC80501_VOLT(4.2));
+    TEST_CHECK(dev.SoftReset(&dev).data == 0, "SoftReset");
+    Test_Vout(&probe, &dev, 2.5, 4.2);
+
+    //更改基准电压后输出保持不变
+    dev.SetDacOut(&dev, DAC80501_VOLT(1.8));
+    TEST_CHECK(dev.SetRefVolt(&dev, DAC80501_VOLT(4.096)).data == 0, "SetRefVolt");
+    Test_Vout(&probe, &dev, 4.096, 1.8);
+
+    dev.SetDacOut(&dev, DAC80501_VOLT(5.4));
+    Test_Vout(&probe, &dev, 4.096, 5.4);
+
+    //SetRefPower只切换基准源，输出须重新设置
+    TEST_CHECK(dev.SetRefPower(&dev, 0).data == 0, "SetRefPower");
+    TEST_CHECK(dev.SetDacOut(&dev, DAC80501_VOLT(5.4)).out_volt == 1, "5.4V accepted with 2.5V ref");
+    dev.SetDacOut(&dev, DAC80501_VOLT(2.0));
+    Test_Vout(&probe, &dev, 2.5, 2.0);
+
+    //批量发送
+    dev.BeginBatch(&dev);
+    dev.SetDacOut(&dev, DAC80501_VOLT(0.3));
+    dev.SetDacOut(&dev, DAC80501_VOLT(0.4));
+    Dac80501_ProbeClear(&probe);
+    dev.EndBatch(&dev);
+    TEST_CHECK(probe.writes == 1, "batch took %u writes", probe.writes);
+    Test_Vout(&probe, &dev, 2.5, 0.4);
+
+    TEST_CHECK(dev.DeInit(&dev, NULL).data == 0, "DeInit");
+}
+
+static void Test_Group(void)
+{
+    dac80501_probe_t probe[TEST_GROUP];
+    dac80501_t dev[TEST_GROUP];
+    dac80501_t* devs[TEST_GROUP];
+    DAC80501_Transport transports[TEST_GROUP];
+    DAC80501_Volt vout[TEST_GROUP];
+
+    for(int i=0; i<TEST_GROUP; i++)
+    {
+        Dac80501_ProbeInit(&probe[i], 0);
+        DAC80501_SPI_API_INIT(&dev[i]);
+        devs[i] = &dev[i];
+        transports[i] = Dac80501_ProbeTransport(&probe[i]);
+        vout[i] = DAC80501_VOLT(0.5 + i);
+    }
+
+    uint64_t t0 = Dac80501_TestClock();
+    TEST_CHECK(DAC80501_GroupInitTransport(devs, transports, vout, TEST_GROUP, NULL).data == 0, "group init");
+    TEST_CHECK(Dac80501_TestClock() - t0 == 2000, "group init took %llu us", (unsigned long long)(Dac80501_TestClock() - t0));
+
+    for(int i=0; i<TEST_GROUP; i++)
+    {
+        Test_Vout(&probe[i], &dev[i], 2.5, 0.5 + i);
+        dev[i].DeInit(&dev[i], NULL);
+    }
+}
+
+//SetDacOut的单次耗时，传输接口只计数，不含芯片模型
+static void Test_Bench(void)
+{
+    uint32_t frames = 0;
+    DAC80501_Transport transport = Dac80501_CountTransport(&frames);
+    dac80501_t dev;
+
+    DAC80501_SPI_API_INIT(&dev);
+    dev.InitTransport(&dev, &transport, DAC80501_VOLT(0), NULL);
+
+    const DAC80501_Volt level[4] = {DAC80501_VOLT(0.3), DAC80501_VOLT(1.1), DAC80501_VOLT(2.4), DAC80501_VOLT(4.7)};
+
+    frames = 0;
+
+    uint64_t t0 = Dac80501_TestNanos();
+    uint64_t c0 = TEST_CYCLES();
+    for(int i=0; i<TEST_BENCH_LOOPS; i++)
+        dev.SetDacOut(&dev, level[i & 3]);
+    uint64_t c1 = TEST_CYCLES();
+    uint64_t t1 = Dac80501_TestNanos();
+
+    printf("%s: SetDacOut %.1f ns, %.0f TSC cycles, %.2f frames per call, sizeof(dac80501_t) %u\n", Test_ProfileName(),
+        (double)(t1 - t0) / TEST_BENCH_LOOPS, (double)(c1 - c0) / TEST_BENCH_LOOPS,
+        (double)frames / TEST_BENCH_LOOPS, (unsigned)sizeof(dac80501_t));
+
+    dev.DeInit(&dev, NULL);
+}
+
+int main(void)
+{
+    Test_Functional();
+    Test_Group();
+    Test_Bench();
+
+    return TEST_REPORT(Test_ProfileName());
+}
@@ -0,0 +1,154 @@
+/*
+@filename   test_range.c
+
+@brief		切换量程测试：逐帧记录实际输出，检查任意两个电压之间切换时中间输出不超过起止电压中的较大值，
+            同步模式下同样成立，并统计到达正确输出所需的帧数
+
+@time		2026/10/18
+
+@author		丁鹏龙
+*/
+#include "dac80501_test.h"
+
+#include <math.h>
+
+//电压网格步长，单位V
+#define TEST_STEP 0.05
+
+typedef struct
+{
+    uint32_t transitions;   //切换次数
+    uint32_t switches;      //其中改变量程的次数
+    uint32_t outside;       //中间输出位于起止电压之外的次数
+    uint32_t frames;        //到达终点之前的数据帧数之和
+    double   overshoot;     //中间输出超过较大值的最大幅度，单位V
+}test_stats_t;
+
+//以SetDacOut由start切换到end，逐帧检查
+static void Test_Transition(dac80501_probe_t* probe, dac80501_t* dev, double ref, int sync, double start, double end, test_stats_t* st)
+{
+    dev->SetDacOut(dev, DAC80501_VOLT(start));
+    if(sync)
+        dev->SetLDAC(dev, 1);
+
+    uint8_t range0, range1;
+    dev->GetDacRange(dev, &range0);
+    Dac80501_ProbeClear(probe);
+
+    dev->SetDacOut(dev, DAC80501_VOLT(end));
+    if(sync)
+        dev->SetLDAC(dev, 1);
+
+    dev->GetDacRange(dev, &range1);
+
+    double lsb = TEST_LSB(ref, (range0 > range1) ? range0 : range1);
+    double hi = ((start > end) ? start : end) + lsb;
+    double lo = ((start < end) ? start : end) - lsb;
+    double vout = Dac80501_ProbeVout(probe);
+    double fs = ref * (1 << range1) / 2;
+
+    st->transitions++;
+    st->switches += (range0 != range1);
+
+    //终点误差不超过0.5LSB，满量程限幅时不超过1LSB
+    double limit = (end > fs - TEST_LSB(ref, range1) / 2) ? 1.0 : 0.5;
+    TEST_CHECK(fabs(vout - end) <= limit * TEST_LSB(ref, range1) + 1e-9, "%s %.3f->%.3f: end %.6f",
+        sync ? "sync" : "async", start, end, vout);
+
+    //逐帧检查中间输出
+    int outside = 0;
+    int settle = 0;
+
+    for(uint16_t i=0; i<probe->log_count; i++)
+    {
+        double v = probe->log[i];
+
+        TEST_CHECK((v <= hi) && (v >= 0) && (v <= DAC80501_MAX_VOUT), "%s %.3f->%.3f: frame %u output %.6f",
+            sync ? "sync" : "async", start, end, i, v);
+
+        if(v - hi + lsb > st->overshoot)
+            st->overshoot = v - hi + lsb;
+
+        if(fabs(v - end) > lsb)
+        {
+            settle = i + 1;
+            outside |= (v < lo);
+        }
+    }
+
+    st->outside += outside;
+    st->frames += settle;
+}
+
+static void Test_Grid(double ref, int sync)
+{
+    dac80501_probe_t probe;
+    dac80501_t dev;
+    test_stats_t st = {0};
+    double vmax = (ref * 2 < DAC80501_MAX_VOUT) ? ref * 2 : DAC80501_MAX_VOUT;
+
+    Dac80501_ProbeInit(&probe, ref);
+    Dac80501_ProbeOpen(&probe, &dev, DAC80501_VOLT(0));
+
+    if(ref != DAC80501_INTERNAL_VREF)
+        dev.SetRefVolt(&dev, DAC80501_VOLT(ref));
+    if(sync)
+        dev.SetDacSync(&dev, 1);
+
+    int n = (int)(vmax / TEST_STEP);
+
+    for(int i=0; i<=n; i++)
+        for(int j=0; j<=n; j++)
+            if(i != j)
+                Test_Transition(&probe, &dev, ref, sync, i * TEST_STEP, j * TEST_STEP, &st);
+
+    printf("ref %.3f V %-5s: %u transitions, %u range switches, max %.3f uV above the larger end, "
+        "%u intermediates below both ends, %.3f frames to settle on average\n",
+        ref, sync ? "sync" : "async", st.transitions, st.switches, st.overshoot * 1e6,
+        st.outside, (double)st.frames / st.transitions);
+
+    dev.DeInit(&dev, NULL);
+}
+
+//SetDacRange只写GAIN寄存器，输出随满量程成比例变化
+static void Test_SetDacRange(void)
+{
+    dac80501_probe_t probe;
+    dac80501_t dev;
+
+    Dac80501_ProbeInit(&probe, 0);
+    Dac80501_ProbeOpen(&probe, &dev, DAC80501_VOLT(1.0));
+
+    //1.0V位于HALF量程，切换到UNITY后输出加倍
+    dev.SetDacRange(&dev, DAC80501_RANGE_UNITY);
+    double vout = Dac80501_ProbeVout(&probe);
+    TEST_CHECK((probe.frames == 1) && (fabs(vout - 2.0) <= TEST_LSB(2.5, 1)), "SetDacRange: %u frames, %.6f", probe.frames, vout);
+
+    //SetDacRangeCode按防超调顺序写入，中间输出为新数据在旧量程下的电压
+    dev.SetDacOut(&dev, DAC80501_VOLT(0.5));
+    Dac80501_ProbeClear(&probe);
+    dev.SetDacRangeCode(&dev, DAC80501_RANGE_DOUBLE, 0x4000);
+    vout = Dac80501_ProbeVout(&probe);
+    TEST_CHECK((probe.frames == 2) && (probe.log[0] <= 0.3125 + TEST_LSB(2.5, 0)) && (fabs(vout - 1.25) <= TEST_LSB(2.5, 2)),
+        "SetDacRangeCode: %u frames, %.6f -> %.6f", probe.frames, probe.log[0], vout);
+
+    //非法量程返回param错误，不写入任何数据
+    Dac80501_ProbeClear(&probe);
+    DAC80501_Error error = dev.SetDacRange(&dev, DAC80501_RANGE_DOUBLE + 1);
+    TEST_CHECK((error.param == 1) && (error.gain == 0), "SetDacRange(3): error %#x", (unsigned)error.data);
+    error = dev.SetDacRangeCode(&dev, DAC80501_RANGE_DOUBLE + 1, 0x1000);
+    TEST_CHECK((error.param == 1) && (error.gain == 0), "SetDacRangeCode(3): error %#x", (unsigned)error.data);
+    TEST_CHECK(probe.frames == 0, "invalid range sent %u frames", probe.frames);
+
+    dev.DeInit(&dev, NULL);
+}
+
+int main(void)
+{
+    Test_Grid(DAC80501_INTERNAL_VREF, 0);
+    Test_Grid(DAC80501_INTERNAL_VREF, 1);
+    Test_Grid(4.096, 0);
+    Test_SetDacRange();
+
+    return TEST_REPORT("range");
+}
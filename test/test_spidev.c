@@ -0,0 +1,75 @@
+/*
+@filename   test_spidev.c
+
+@brief		spidev传输接口测试：以桩函数代替系统调用，检查每次ioctl的帧数、片选时序和芯片模型收到的数据
+
+@time		2026/10/18
+
+@author		丁鹏龙
+*/
+#include "dac80501_test.h"
+
+#include <math.h>
+
+int main(void)
+{
+    dac80501_sim_t sim;
+    dac80501_spidev_t spidev;
+    dac80501_t dev;
+    DAC80501_Transport transport;
+    char path[32];
+
+    DAC80501_SIM_API_INIT(&sim);
+    sim.Init(&sim, 0);
+    snprintf(path, sizeof(path), "sim:%d", Dac80501_FakeSpidevAttach(&sim));
+
+    DAC80501_SPIDEV_API_INIT(&spidev);
+    Dac80501_FakeSpidevBind(&spidev);
+
+    //打开不存在的设备失败
+    TEST_CHECK(spidev.Open(&spidev, "sim:99", 10000000).spi == 1, "open bad path");
+    TEST_CHECK(spidev.fd < 0, "fd after failed open");
+
+    TEST_CHECK(spidev.Open(&spidev, path, 10000000).data == 0, "open %s", path);
+    spidev.GetTransport(&spidev, &transport);
+
+    DAC80501_SPI_API_INIT(&dev);
+    TEST_CHECK(dev.InitTransport(&dev, &transport, DAC80501_VOLT(1.0), NULL).data == 0, "init");
+
+    double vout;
+    sim.GetVout(&sim, &vout);
+    TEST_CHECK(fabs(vout - 1.0) <= TEST_LSB(2.5, 0), "init vout %.6f", vout);
+
+    //切换量程的GAIN和DAC数据帧合并为一次ioctl
+    sim.ClearStats(&sim);
+    uint32_t messages = Dac80501_FakeSpidevMessages();
+    dev.SetDacOut(&dev, DAC80501_VOLT(4.0));
+    TEST_CHECK(Dac80501_FakeSpidevMessages() - messages == 1, "range switch took %u ioctls", Dac80501_FakeSpidevMessages() - messages);
+    TEST_CHECK(sim.frames == 2, "range switch sent %u frames", sim.frames);
+
+    //超过DAC80501_SPIDEV_MAX_XFER帧时分为多次ioctl
+    uint8_t frames[130 * 3];
+    for(int i=0; i<130; i++)
+    {
+        frames[i * 3]       = 0x08;
+        frames[i * 3 + 1]   = (uint8_t)(i >> 8);
+        frames[i * 3 + 2]   = (uint8_t)i;
+    }
+
+    sim.ClearStats(&sim);
+    messages = Dac80501_FakeSpidevMessages();
+    TEST_CHECK(transport.Write(transport.handle, frames, 130).data == 0, "write 130 frames");
+    TEST_CHECK(Dac80501_FakeSpidevMessages() - messages == 3, "130 frames took %u ioctls", Dac80501_FakeSpidevMessages() - messages);
+    TEST_CHECK(sim.frames == 130, "sim got %u frames", sim.frames);
+    TEST_CHECK(sim.dac_active == 129, "last frame 0x%04x", sim.dac_active);
+    TEST_CHECK(Dac80501_FakeSpidevErrors() == 0, "%u transfers without cs_change", Dac80501_FakeSpidevErrors());
+
+    //关闭后写入返回spi错误
+    TEST_CHECK(spidev.Close(&spidev).data == 0, "close");
+    TEST_CHECK(transport.Write(transport.handle, frames, 1).spi == 1, "write after close");
+    TEST_CHECK(sim.bad_frames == 0, "%u bad frames", sim.bad_frames);
+
+    dev.DeInit(&dev, NULL);
+
+    return TEST_REPORT("spidev");
+}
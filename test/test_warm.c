@@ -0,0 +1,145 @@
+/*
+@filename   test_warm.c
+
+@brief		热启动测试：以虚拟时钟统计N个设备冷启动与热启动的初始化耗时和数据帧数，
+            并检查快照无效时退回软重置、热启动过程中输出不回到0V
+
+@time		2026/10/18
+
+@author		丁鹏龙
+*/
+#include "dac80501_test.h"
+
+#include <math.h>
+
+#define TEST_MAX_N 64
+
+static dac80501_probe_t probe[TEST_MAX_N];
+static dac80501_t dev[TEST_MAX_N];
+static DAC80501_Snapshot snapshot[TEST_MAX_N];
+
+/*
+    逐个初始化N个设备，返回虚拟时钟耗时
+    warm: 为1时以快照热启动
+*/
+static uint64_t Test_Boot(int n, int warm, double vout, uint32_t* frames, uint32_t* resets)
+{
+    *frames = 0;
+    *resets = 0;
+
+    uint64_t t0 = Dac80501_TestClock();
+
+    for(int i=0; i<n; i++)
+    {
+        DAC80501_Transport transport = Dac80501_ProbeTransport(&probe[i]);
+        uint32_t resets0 = probe[i].sim.resets;
+
+        Dac80501_ProbeClear(&probe[i]);
+        DAC80501_SPI_API_INIT(&dev[i]);
+
+        if(warm)
+            dev[i].SetWarmStart(&dev[i], &snapshot[i]);
+
+        TEST_CHECK(dev[i].InitTransport(&dev[i], &transport, DAC80501_VOLT(vout), NULL).data == 0, "init %d", i);
+
+        *frames += probe[i].frames;
+        *resets += probe[i].sim.resets - resets0;
+    }
+
+    return Dac80501_TestClock() - t0;
+}
+
+/*
+    模拟MCU复位而DAC80501保持供电：保存快照后释放驱动，芯片模型的寄存器保持不变
+*/
+static void Test_McuReset(int n)
+{
+    for(int i=0; i<n; i++)
+    {
+        dac80501_sim_t sim = probe[i].sim;
+
+        dev[i].SaveSnapshot(&dev[i], &snapshot[i]);
+        dev[i].DeInit(&dev[i], NULL);
+
+        probe[i].sim = sim;
+    }
+}
+
+static void Test_BootTime(int n)
+{
+    uint32_t frames, resets;
+
+    for(int i=0; i<n; i++)
+        Dac80501_ProbeInit(&probe[i], 0);
+
+    uint64_t cold = Test_Boot(n, 0, 1.7, &frames, &resets);
+    printf("N=%2d cold: %6llu us, %3u frames, %2u resets\n", n, (unsigned long long)cold, frames, resets);
+    TEST_CHECK(resets == (uint32_t)n, "cold resets %u", resets);
+
+    //期望输出与快照一致时不发送任何数据帧
+    Test_McuReset(n);
+    uint64_t warm = Test_Boot(n, 1, 1.7, &frames, &resets);
+    printf("N=%2d warm: %6llu us, %3u frames, %2u resets\n", n, (unsigned long long)warm, frames, resets);
+    TEST_CHECK((warm == 0) && (frames == 0) && (resets == 0), "warm same: %llu us, %u frames", (unsigned long long)warm, frames);
+
+    for(int i=0; i<n; i++)
+    {
+        double vout = Dac80501_ProbeVout(&probe[i]);
+        TEST_CHECK(fabs(vout - 1.7) <= TEST_LSB(2.5, 1), "warm vout[%d] %.6f", i, vout);
+    }
+
+    //期望输出改变时只发送不同的GAIN和DAC数据帧
+    Test_McuReset(n);
+    warm = Test_Boot(n, 1, 3.1, &frames, &resets);
+    printf("N=%2d warm, new output: %6llu us, %3u frames, %2u resets\n", n, (unsigned long long)warm, frames, resets);
+    TEST_CHECK((warm == 0) && (frames == 2 * (uint32_t)n) && (resets == 0), "warm new: %llu us, %u frames",
+        (unsigned long long)warm, frames);
+
+    //量程变大时先写DAC数据，中间输出为新数据在旧量程下的电压，不超过终点，也不会像软重置一样回到0V
+    for(int i=0; i<n; i++)
+        TEST_CHECK((probe[i].vout_min >= 3.1 / 2 - TEST_LSB(2.5, 1)) && (probe[i].vout_max <= 3.1 + TEST_LSB(2.5, 2)),
+            "warm output %.6f~%.6f", probe[i].vout_min, probe[i].vout_max);
+
+    for(int i=0; i<n; i++)
+        dev[i].DeInit(&dev[i], NULL);
+}
+
+//快照校验失败或芯片已掉电时退回软重置
+static void Test_Fallback(void)
+{
+    uint32_t frames, resets;
+
+    Dac80501_ProbeInit(&probe[0], 0);
+    Test_Boot(1, 0, 2.0, &frames, &resets);
+    Test_McuReset(1);
+
+    snapshot[0].dac ^= 1;
+    uint64_t t = Test_Boot(1, 1, 2.0, &frames, &resets);
+    TEST_CHECK((resets == 1) && (t >= 2000), "bad crc: %u resets, %llu us", resets, (unsigned long long)t);
+
+    double vout = Dac80501_ProbeVout(&probe[0]);
+    TEST_CHECK(fabs(vout - 2.0) <= TEST_LSB(2.5, 1), "fallback vout %.6f", vout);
+
+    //快照只对下一次初始化有效，再次初始化时软重置
+    Test_McuReset(1);
+    dev[0].SetWarmStart(&dev[0], &snapshot[0]);
+    DAC80501_Transport transport = Dac80501_ProbeTransport(&probe[0]);
+    TEST_CHECK(dev[0].InitTransport(&dev[0], &transport, DAC80501_VOLT(2.0), NULL).data == 0, "warm init");
+    dev[0].DeInit(&dev[0], NULL);
+
+    uint32_t resets0 = probe[0].sim.resets;
+    TEST_CHECK(dev[0].InitTransport(&dev[0], &transport, DAC80501_VOLT(2.0), NULL).data == 0, "re-init");
+    TEST_CHECK(probe[0].sim.resets - resets0 == 1, "snapshot reused");
+
+    dev[0].DeInit(&dev[0], NULL);
+}
+
+int main(void)
+{
+    Test_BootTime(1);
+    Test_BootTime(8);
+    Test_BootTime(TEST_MAX_N);
+    Test_Fallback();
+
+    return TEST_REPORT("warm");
+}